@@ -68,7 +68,7 @@ static void user_error_fn([[maybe_unused]] png_structp png_ptr, png_const_charp
 
 PNGFormat::PNGFormat()
 	: info_(nullptr), png(nullptr), row_buf(nullptr), row_buf_array(nullptr), row32s(nullptr),
-	  colorSpace_(GRK_CLRSPC_UNKNOWN), prec(0), nr_comp(0)
+	  colorSpace_(GRK_CLRSPC_UNKNOWN), prec(0), nr_comp(0), rowsWritten_(0)
 {}
 
 bool PNGFormat::encodeHeader(void)
@@ -109,11 +109,6 @@ bool PNGFormat::encodeHeader(void)
 			break;
 		if(image_->comps[0].sgnd != image_->comps[i].sgnd)
 			break;
-		if(!image_->comps[i].data)
-		{
-			spdlog::error("imagetopng: component {} is null.", i);
-			return false;
-		}
 	}
 	if(i != nr_comp)
 	{
@@ -293,8 +288,21 @@ bool PNGFormat::encodeHeader(void)
 beach:
 	return !fails;
 }
+/***
+ * application-orchestrated pixel encoding
+ */
 bool PNGFormat::encodePixels(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	for(uint16_t compno = 0; compno < nr_comp; ++compno)
+	{
+		if(!image_->comps[compno].data)
+		{
+			spdlog::error("imagetopng: component {} is null.", compno);
+			return false;
+		}
+	}
 	int32_t const* planes[4];
 	for(uint16_t compno = 0; compno < nr_comp; ++compno)
 		planes[compno] = image_->comps[compno].data;
@@ -318,8 +326,49 @@ bool PNGFormat::encodePixels(void)
 
 	return true;
 }
+/***
+ * library-orchestrated pixel encoding: rows are written synchronously,
+ * so the pixel buffer is returned to the library as soon as it is written
+ */
+bool PNGFormat::encodePixelsCore(uint32_t threadId, grk_io_buf pixels)
+{
+	if(!encodePixelsCoreWrite(pixels))
+	{
+		spdlog::error("PNGFormat::encodePixelsCore: error in pixels encode");
+		encodeState |= IMAGE_FORMAT_ERROR;
+		return false;
+	}
+	ioReclaimBuffer(threadId, GrkIOBuf(pixels));
+	if(rowsWritten_ == image_->comps[0].h)
+		return encodeFinish();
+
+	return true;
+}
+/***
+ * Write interleaved rows to libpng
+ */
+bool PNGFormat::encodePixelsCoreWrite(grk_io_buf pixels)
+{
+	auto rowBytes = png_get_rowbytes(png, info_);
+	if(!rowBytes || pixels.len_ % rowBytes)
+	{
+		spdlog::error("PNGFormat: pixel buffer length {} is not a multiple of row length {}",
+					  pixels.len_, rowBytes);
+		return false;
+	}
+	if(setjmp(png_jmpbuf(png)))
+		return false;
+	auto numRows = (uint32_t)(pixels.len_ / rowBytes);
+	for(uint32_t i = 0; i < numRows; ++i)
+		png_write_row(png, pixels.data_ + i * rowBytes);
+	rowsWritten_ += numRows;
+
+	return true;
+}
 bool PNGFormat::encodeFinish(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
 	if(setjmp(png_jmpbuf(png)))
 		return false;
 
@@ -329,7 +378,10 @@ bool PNGFormat::encodeFinish(void)
 		png_destroy_write_struct(&png, &info_);
 	}
 	free(row_buf);
+	row_buf = nullptr;
 	free(row32s);
+	row32s = nullptr;
+	encodeState |= IMAGE_FORMAT_ENCODED_PIXELS;
 	bool rc = ImageFormat::encodeFinish();
 
 	return rc;
@@ -32,6 +32,10 @@ class PNGFormat : public ImageFormat
 	bool encodeFinish(void) override;
 	grk_image* decode(const std::string& filename, grk_cparameters* parameters) override;
 
+  protected:
+	bool encodePixelsCore(uint32_t threadId, grk_io_buf pixels) override;
+	bool encodePixelsCoreWrite(grk_io_buf pixels) override;
+
   private:
 	grk_image* do_decode(grk_cparameters* params);
 
@@ -43,4 +47,5 @@ class PNGFormat : public ImageFormat
 	GRK_COLOR_SPACE colorSpace_;
 	uint8_t prec;
 	uint16_t nr_comp;
+	uint32_t rowsWritten_;
 };
@@ -38,6 +38,9 @@
 #include <fcntl.h>
 #endif /* _WIN32 */
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 #include <filesystem>
 #include "common.h"
@@ -185,12 +188,12 @@ static void compress_help_display(void)
 	fprintf(stdout, "            quality layer 1: compress 20x, \n");
 	fprintf(stdout, "            quality layer 2: compress 10x \n");
 	fprintf(stdout, "            quality layer 3: compress lossless\n");
-	fprintf(stdout, "    Not supported for Part 15 HTJ2K compression.\n");
+	fprintf(stdout, "    Part 15 HTJ2K compression supports a single layer only.\n");
 	fprintf(stdout, "    Options -r and -q cannot be used together.\n");
 	fprintf(stdout, "[-q|-quality] <psnr value>,<psnr value>,<psnr value>,...\n");
 	fprintf(stdout, "    Specify PSNR for successive layers (-q 30,40,50).\n");
 	fprintf(stdout, "    Increasing PSNR values required.\n");
-	fprintf(stdout, "    Not supported for Part 15 HTJ2K compression.\n");
+	fprintf(stdout, "    Part 15 HTJ2K compression supports a single layer only.\n");
 	fprintf(stdout, "    Note: options -r and -q cannot be used together.\n");
 	fprintf(stdout, "[-A|-rate_control_algorithm] <0|1>\n");
 	fprintf(stdout, "    Select algorithm used for rate control\n");
@@ -321,6 +324,13 @@ static void compress_help_display(void)
 	fprintf(stdout, "    Path to T1 plugin.\n");
 	fprintf(stdout, "[-H|-num_threads] <number of threads>\n");
 	fprintf(stdout, "    Number of threads used by libgrokj2k library.\n");
+	fprintf(stdout, "[-B|-batch] <number of files>\n");
+	fprintf(stdout, "    Number of files in input directory that are compressed concurrently.\n"
+					"    Reading, compressing and writing of different files then overlap.\n"
+					"    Default value is 1.\n");
+	fprintf(stdout, "[-j|-ht_encoder] <HT code block encoder>\n");
+	fprintf(stdout, "    Force HTJ2K code block encoder, for testing: 0 (fastest supported),\n"
+					"    1 (scalar) or 2 (AVX2). Default value is 0.\n");
 	fprintf(stdout, "[-G|-device_id] <device ID>\n");
 	fprintf(stdout, "    (GPU) Specify which GPU accelerator to run codec on.\n");
 	fprintf(stdout, "    A value of -1 will specify all devices.\n");
@@ -486,7 +496,7 @@ int GrkCompress::main(int argc, char** argv, grk_image* in_image, grk_stream_par
 			if(!initParams.inputFolder.set_imgdir)
 			{
 				initParams.parameters = parametersCache;
-				if(compress("", &initParams) == 0)
+				if(compress("", &initParams, &initParams.parameters) == 0)
 				{
 					success = 1;
 					goto cleanup;
@@ -494,13 +504,18 @@ int GrkCompress::main(int argc, char** argv, grk_image* in_image, grk_stream_par
 				spdlog::info("Compressed file {}", initParams.parameters.outfile);
 				numCompressedFiles++;
 			}
+			else if(parametersCache.batchSize > 1)
+			{
+				numCompressedFiles += compressBatch(&initParams, &parametersCache);
+			}
 			else
 			{
 				for(const auto& entry :
 					std::filesystem::directory_iterator(initParams.inputFolder.imgdirpath))
 				{
 					initParams.parameters = parametersCache;
-					if(compress(entry.path().filename().string(), &initParams) == 1)
+					if(compress(entry.path().filename().string(), &initParams,
+								&initParams.parameters) == 1)
 					{
 						spdlog::info("Compressed file {}", initParams.parameters.outfile);
 						numCompressedFiles++;
@@ -657,6 +672,8 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 			"Number of compress repetitions, for either a folder or a single file", false, 0,
 			"unsigned integer", cmd);
 		TCLAP::SwitchArg ephArg("E", "EPH", "Add EPH markers", cmd);
+		TCLAP::ValueArg<uint32_t> batchArg("B", "batch", "Number of files compressed concurrently",
+										   false, 1, "unsigned integer", cmd);
 
 		TCLAP::ValueArg<std::string> rawFormatArg("F", "raw", "raw image format parameters", false,
 												  "", "string", cmd);
@@ -671,6 +688,8 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 		TCLAP::SwitchArg irreversibleArg("I", "irreversible", "Irreversible", cmd);
 		TCLAP::ValueArg<uint32_t> durationArg("J", "duration", "Duration in seconds", false, 0,
 											  "unsigned integer", cmd);
+		TCLAP::ValueArg<uint32_t> htEncoderArg("j", "ht_encoder", "HT code block encoder", false,
+											   0, "unsigned integer", cmd);
 		// Kernel build flags:
 		// 1 indicates build binary, otherwise load binary
 		// 2 indicates generate binaries
@@ -794,6 +813,18 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 		if(durationArg.isSet())
 			parameters->duration = durationArg.getValue();
 
+		if(batchArg.isSet())
+			parameters->batchSize = batchArg.getValue();
+
+		if(htEncoderArg.isSet())
+		{
+			if(htEncoderArg.getValue() > GRK_HT_ENCODER_AVX2)
+				spdlog::warn("Invalid HT code block encoder {}. Ignoring",
+							 htEncoderArg.getValue());
+			else
+				parameters->htEncoder = (GRK_HT_ENCODER)htEncoderArg.getValue();
+		}
+
 		if(inForArg.isSet())
 		{
 			auto dummy = "dummy." + inForArg.getValue();
@@ -901,20 +932,15 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 				{
 					isHT = true;
 					parameters->numgbits = 1;
-					if(compressionRatiosArg.isSet() || qualityArg.isSet())
-					{
-						spdlog::warn("HTJ2K compression using rate distortion or quality"
-									 " is not currently supported.");
-					}
 				}
 			}
 		}
-		if(!isHT && compressionRatiosArg.isSet() && qualityArg.isSet())
+		if(compressionRatiosArg.isSet() && qualityArg.isSet())
 		{
 			spdlog::error("compression by both rate distortion and quality is not allowed");
 			return 1;
 		}
-		if(!isHT && compressionRatiosArg.isSet())
+		if(compressionRatiosArg.isSet())
 		{
 			char* s = (char*)compressionRatiosArg.getValue().c_str();
 			parameters->numlayers = 0;
@@ -955,7 +981,7 @@ int GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* ini
 					parameters->layer_rate[i] = 0;
 			}
 		}
-		else if(!isHT && qualityArg.isSet())
+		else if(qualityArg.isSet())
 		{
 			char* s = (char*)qualityArg.getValue().c_str();
 			;
@@ -2191,30 +2217,31 @@ cleanup:
 
 // returns 0 if failed, 1 if succeeded,
 // and 2 if file is not suitable for compression
-int GrkCompress::compress(const std::string& inputFile, CompressInitParams* initParams)
+int GrkCompress::compress(const std::string& inputFile, CompressInitParams* initParams,
+						  grk_cparameters* parameters)
 {
 	// clear for next file compress
-	initParams->parameters.write_capture_resolution_from_file = false;
+	parameters->write_capture_resolution_from_file = false;
 	// don't reset format if reading from STDIN
-	if(initParams->parameters.infile[0])
-		initParams->parameters.decod_format = GRK_FMT_UNK;
+	if(parameters->infile[0])
+		parameters->decod_format = GRK_FMT_UNK;
 	if(initParams->inputFolder.set_imgdir)
 	{
 		if(nextFile(inputFile, &initParams->inputFolder,
 					initParams->outFolder.set_imgdir ? &initParams->outFolder
 													 : &initParams->inputFolder,
-					&initParams->parameters))
+					parameters))
 		{
 			return 2;
 		}
 	}
 	grk_plugin_compress_user_callback_info callbackInfo;
 	memset(&callbackInfo, 0, sizeof(grk_plugin_compress_user_callback_info));
-	callbackInfo.compressor_parameters = &initParams->parameters;
+	callbackInfo.compressor_parameters = parameters;
 	callbackInfo.image = initParams->in_image;
 	callbackInfo.out_buffer = initParams->out_buffer;
-	callbackInfo.output_file_name = initParams->parameters.outfile;
-	callbackInfo.input_file_name = initParams->parameters.infile;
+	callbackInfo.output_file_name = parameters->outfile;
+	callbackInfo.input_file_name = parameters->infile;
 	callbackInfo.transferExifTags = initParams->transferExifTags;
 
 	uint64_t compressedBytes = pluginCompressCallback(&callbackInfo);
@@ -2224,4 +2251,39 @@ int GrkCompress::compress(const std::string& inputFile, CompressInitParams* init
 	return compressedBytes ? 1 : 0;
 }
 
+size_t GrkCompress::compressBatch(CompressInitParams* initParams, grk_cparameters* parametersCache)
+{
+	std::vector<std::string> files;
+	for(const auto& entry : std::filesystem::directory_iterator(initParams->inputFolder.imgdirpath))
+		files.push_back(entry.path().filename().string());
+	std::atomic<size_t> nextFileIndex(0);
+	std::atomic<size_t> numCompressedFiles(0);
+	auto numWorkers = (std::min)((size_t)parametersCache->batchSize, files.size());
+	// each worker takes the next file from the directory, and runs it through
+	// source image decoding, compression and writing, so that different stages
+	// of different files overlap. Compression of all files shares the library
+	// executor, and T1 compressors are recycled between files with identical
+	// code block geometry
+	auto worker = [&]() {
+		grk_cparameters parameters;
+		size_t i;
+		while((i = nextFileIndex++) < files.size())
+		{
+			parameters = *parametersCache;
+			if(compress(files[i], initParams, &parameters) == 1)
+			{
+				spdlog::info("Compressed file {}", parameters.outfile);
+				numCompressedFiles++;
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for(size_t i = 0; i < numWorkers; ++i)
+		workers.emplace_back(worker);
+	for(auto& w : workers)
+		w.join();
+
+	return numCompressedFiles;
+}
+
 } // namespace grk
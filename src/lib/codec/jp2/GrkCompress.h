@@ -46,7 +46,10 @@ class GrkCompress
 	int pluginBatchCompress(CompressInitParams* initParams);
 	int pluginMain(int argc, char** argv, CompressInitParams* initParams);
 	int parseCommandLine(int argc, char** argv, CompressInitParams* initParams);
-	int compress(const std::string& inputFile, CompressInitParams* initParams);
+	int compress(const std::string& inputFile, CompressInitParams* initParams,
+				 grk_cparameters* parameters);
+	// compress all files in input directory, with several files in flight
+	size_t compressBatch(CompressInitParams* initParams, grk_cparameters* parametersCache);
 };
 
 } // namespace grk
@@ -33,8 +33,12 @@
 #endif /* _WIN32 */
 #include <climits>
 #include <string>
+#include <vector>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include "grk_apps_config.h"
 #include "common.h"
@@ -104,6 +108,50 @@ void setUpSignalHandler()
 #endif
 }
 
+/**
+ * Bounds the memory held by decompressed images of files in flight
+ * in batch mode
+ */
+class DecompressBatch
+{
+  public:
+	explicit DecompressBatch(uint64_t budget) : budget_(budget), bytesInFlight_(0) {}
+	/**
+	 * Reserve memory for decompressed image, waiting until enough memory
+	 * has been released by other files. A file is always admitted
+	 * if no other file is in flight, so that an image larger than the budget
+	 * can still be decompressed.
+	 *
+	 * @param bytes number of bytes to reserve
+	 */
+	void acquire(uint64_t bytes)
+	{
+		if(!budget_)
+			return;
+		std::unique_lock<std::mutex> lk(mutex_);
+		cv_.wait(lk, [this, bytes] {
+			return bytesInFlight_ == 0 || bytesInFlight_ + bytes <= budget_;
+		});
+		bytesInFlight_ += bytes;
+	}
+	void release(uint64_t bytes)
+	{
+		if(!budget_ || !bytes)
+			return;
+		{
+			std::unique_lock<std::mutex> lk(mutex_);
+			bytesInFlight_ -= bytes;
+		}
+		cv_.notify_all();
+	}
+
+  private:
+	uint64_t budget_;
+	uint64_t bytesInFlight_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+};
+
 static void decompress_help_display(void)
 {
 	fprintf(stdout,
@@ -139,6 +187,20 @@ static void decompress_help_display(void)
 					"    Path to T1 plugin.\n");
 	fprintf(stdout, "  [-H | -num_threads] <number of threads>\n"
 					"    Number of threads used by libgrokj2k library.\n");
+	fprintf(stdout, "  [-I | -index]\n"
+					"    Store tile part and packet lengths in code stream index file\n"
+					"    <input file>.grkidx, and use the index in place of missing TLM and PLT\n"
+					"    markers when the file is decompressed again.\n");
+	fprintf(stdout, "  [-B | -batch] <number of files>\n"
+					"    Number of files in input directory that are decompressed concurrently.\n"
+					"    Reading, decompressing and storing of different files then overlap.\n"
+					"    Default value is 1.\n");
+	fprintf(stdout, "  [-M | -batch_memory] <megabytes>\n"
+					"    Memory budget for decompressed images of files in flight, when\n"
+					"    -batch is set. Default value is 0 (no limit).\n");
+	fprintf(stdout, "  [-J | -ht_decoder] <HT code block decoder>\n"
+					"    Force HTJ2K code block decoder, for testing: 0 (fastest supported),\n"
+					"    1 (scalar), 2 (SSSE3) or 3 (AVX2). Default value is 0.\n");
 	fprintf(stdout,
 			"  [-c|-compression] <compression method>\n"
 			"   Compress output image data. Currently, this option is only applicable when\n"
@@ -408,6 +470,8 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 											   "string", cmd);
 		TCLAP::ValueArg<std::string> compressionArg("c", "compression", "compression Type", false,
 													"", "string", cmd);
+		TCLAP::ValueArg<uint32_t> batchArg("B", "batch", "Number of files decompressed concurrently",
+										   false, 1, "unsigned integer", cmd);
 		TCLAP::ValueArg<std::string> decodeRegionArg("d", "region", "Decompress Region", false, "",
 													 "string", cmd);
 		TCLAP::ValueArg<uint32_t> repetitionsArg(
@@ -423,6 +487,9 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 												"unsigned integer", cmd);
 		TCLAP::ValueArg<std::string> inputFileArg("i", "in_file", "Input file", false, "", "string",
 												  cmd);
+		TCLAP::SwitchArg indexArg("I", "index", "Code stream index sidecar", cmd);
+		TCLAP::ValueArg<uint32_t> htDecoderArg("J", "ht_decoder", "HT code block decoder", false, 0,
+											   "unsigned integer", cmd);
 		TCLAP::ValueArg<uint16_t> layerArg("l", "layer", "layer", false, 0, "unsigned integer",
 										   cmd);
 		TCLAP::ValueArg<uint32_t> randomAccessArg("m", "random_access",
@@ -436,6 +503,9 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 														false, 0, "unsigned integer", cmd);
 		TCLAP::ValueArg<uint32_t> compressionLevelArg("L", "compression_level", "compression Level",
 													  false, UINT_MAX, "unsigned integer", cmd);
+		TCLAP::ValueArg<uint64_t> batchMemoryArg("M", "batch_memory",
+												 "Memory budget in MB for batch mode", false, 0,
+												 "unsigned integer", cmd);
 		TCLAP::ValueArg<std::string> outputFileArg("o", "out_file", "Output file", false, "",
 												   "string", cmd);
 		TCLAP::ValueArg<std::string> outForArg("O", "out_fmt", "Output Format", false, "", "string",
@@ -660,6 +730,19 @@ int GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParams*
 			return 1;
 		if(numThreadsArg.isSet())
 			parameters->numThreads = numThreadsArg.getValue();
+		parameters->index_sidecar = indexArg.isSet();
+		if(batchArg.isSet())
+			parameters->batchSize = batchArg.getValue();
+		if(batchMemoryArg.isSet())
+			parameters->batchMemory = batchMemoryArg.getValue() * 1024 * 1024;
+		if(htDecoderArg.isSet())
+		{
+			if(htDecoderArg.getValue() > GRK_HT_DECODER_AVX2)
+				spdlog::warn("Invalid HT code block decoder {}. Ignoring",
+							 htDecoderArg.getValue());
+			else
+				parameters->core.htDecoder = (GRK_HT_DECODER)htDecoderArg.getValue();
+		}
 		if(decodeRegionArg.isSet())
 		{
 			size_t size_optarg = (size_t)strlen(decodeRegionArg.getValue().c_str()) + 1U;
@@ -741,6 +824,7 @@ void GrkDecompress::setDefaultParams(grk_decompress_parameters* parameters)
 		grk_decompress_set_default_params(parameters);
 		parameters->deviceId = 0;
 		parameters->repeats = 1;
+		parameters->batchSize = 1;
 		parameters->compressionLevel = GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT;
 	}
 }
@@ -757,14 +841,15 @@ void GrkDecompress::destoryParams(grk_decompress_parameters* parameters)
 static int decompress_callback(grk_plugin_decompress_callback_info* info);
 
 // returns 0 for failure, 1 for success, and 2 if file is not suitable for decoding
-int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams* initParams)
+int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams* initParams,
+								  grk_decompress_parameters* parameters)
 {
 	if(initParams->inputFolder.set_imgdir)
 	{
 		if(nextFile(fileName, &initParams->inputFolder,
 					initParams->outFolder.set_imgdir ? &initParams->outFolder
 													 : &initParams->inputFolder,
-					&initParams->parameters))
+					parameters))
 		{
 			return 2;
 		}
@@ -773,7 +858,7 @@ int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams*
 	memset(&info, 0, sizeof(grk_plugin_decompress_callback_info));
 	info.decod_format = GRK_CODEC_UNK;
 	info.decompress_flags = GRK_DECODE_ALL;
-	info.decompressor_parameters = &initParams->parameters;
+	info.decompressor_parameters = parameters;
 	info.user_data = this;
 	info.cod_format =
 		info.cod_format != GRK_FMT_UNK ? info.cod_format : info.decompressor_parameters->cod_format;
@@ -795,14 +880,47 @@ int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams*
 		return 0;
 	}
 #ifdef GROK_HAVE_EXIFTOOL
-	if(initParams->transferExifTags && initParams->parameters.decod_format == GRK_CODEC_JP2)
-		transferExifTags(initParams->parameters.infile, initParams->parameters.outfile);
+	if(initParams->transferExifTags && parameters->decod_format == GRK_CODEC_JP2)
+		transferExifTags(parameters->infile, parameters->outfile);
 #endif
 	grk_object_unref(info.codec);
 	info.codec = nullptr;
 	return 1;
 }
 
+uint32_t GrkDecompress::decompressBatch(DecompressInitParams* initParams)
+{
+	std::vector<std::string> files;
+	for(const auto& entry : std::filesystem::directory_iterator(initParams->inputFolder.imgdirpath))
+		files.push_back(entry.path().filename().string());
+	DecompressBatch batch(initParams->parameters.batchMemory);
+	std::atomic<size_t> nextFileIndex(0);
+	std::atomic<uint32_t> numDecompressed(0);
+	auto numWorkers = (std::min)((size_t)initParams->parameters.batchSize, files.size());
+	// each worker takes the next file from the directory, and runs it through
+	// header parsing, decompression and output encoding, so that different
+	// stages of different files overlap. Decompression of all files shares the
+	// library executor
+	auto worker = [&]() {
+		GrkDecompress decompressor;
+		decompressor.batch = &batch;
+		grk_decompress_parameters parameters = initParams->parameters;
+		size_t i;
+		while((i = nextFileIndex++) < files.size())
+		{
+			if(decompressor.decompress(files[i], initParams, &parameters) == 1)
+				numDecompressed++;
+		}
+	};
+	std::vector<std::thread> workers;
+	for(size_t i = 0; i < numWorkers; ++i)
+		workers.emplace_back(worker);
+	for(auto& w : workers)
+		w.join();
+
+	return numDecompressed;
+}
+
 int GrkDecompress::pluginMain(int argc, char** argv, DecompressInitParams* initParams)
 {
 	grk_dircnt* dirptr = nullptr;
@@ -1086,7 +1204,14 @@ int GrkDecompress::preProcess(grk_plugin_decompress_callback_info* info)
 		grk_stream_params stream_params;
 		memset(&stream_params, 0, sizeof(stream_params));
 		stream_params.file = infile;
+		std::string indexFile;
+		if(parameters->index_sidecar)
+		{
+			indexFile = std::string(infile) + ".grkidx";
+			parameters->core.index_file = indexFile.c_str();
+		}
 		info->codec = grk_decompress_init(&stream_params, &parameters->core);
+		parameters->core.index_file = nullptr;
 		if(!info->codec)
 		{
 			spdlog::error("grk_decompress: failed to set up the decompressor");
@@ -1173,6 +1298,15 @@ int GrkDecompress::preProcess(grk_plugin_decompress_callback_info* info)
 	// header-only decompress
 	if(info->decompress_flags == GRK_DECODE_HEADER)
 		goto cleanup;
+	if(batch && !batchBytes)
+	{
+		for(uint32_t i = 0; i < info->image->numcomps; ++i)
+		{
+			auto comp = info->image->comps + i;
+			batchBytes += (uint64_t)comp->w * comp->h * sizeof(int32_t);
+		}
+		batch->acquire(batchBytes);
+	}
 	// 3. decompress
 	if(info->tile)
 		info->tile->decompress_flags = info->decompress_flags;
@@ -1220,6 +1354,7 @@ cleanup:
 		info->image = nullptr;
 		delete imageFormat;
 		imageFormat = nullptr;
+		releaseBatchMemory();
 	}
 
 	return failed ? 1 : 0;
@@ -1292,6 +1427,7 @@ cleanup:
 	}
 	delete imageFormat;
 	imageFormat = nullptr;
+	releaseBatchMemory();
 	if(failed)
 		cleanUpFile(outfile);
 
@@ -1327,7 +1463,7 @@ int GrkDecompress::main(int argc, char** argv)
 			std::string filename;
 			if(!initParams.inputFolder.set_imgdir)
 			{
-				if(decompress(filename, &initParams) == 1)
+				if(decompress(filename, &initParams, &initParams.parameters) == 1)
 				{
 					numDecompressed++;
 				}
@@ -1337,12 +1473,17 @@ int GrkDecompress::main(int argc, char** argv)
 					goto cleanup;
 				}
 			}
+			else if(initParams.parameters.batchSize > 1)
+			{
+				numDecompressed += decompressBatch(&initParams);
+			}
 			else
 			{
 				for(const auto& entry :
 					std::filesystem::directory_iterator(initParams.inputFolder.imgdirpath))
 				{
-					if(decompress(entry.path().filename().string(), &initParams) == 1)
+					if(decompress(entry.path().filename().string(), &initParams,
+								  &initParams.parameters) == 1)
 						numDecompressed++;
 				}
 			}
@@ -1360,9 +1501,18 @@ cleanup:
 	grk_deinitialize();
 	return rc;
 }
-GrkDecompress::GrkDecompress() : storeToDisk(true), imageFormat(nullptr) {}
+void GrkDecompress::releaseBatchMemory(void)
+{
+	if(batch)
+		batch->release(batchBytes);
+	batchBytes = 0;
+}
+GrkDecompress::GrkDecompress()
+	: storeToDisk(true), imageFormat(nullptr), batch(nullptr), batchBytes(0)
+{}
 GrkDecompress::~GrkDecompress(void)
 {
+	releaseBatchMemory();
 	delete imageFormat;
 	imageFormat = nullptr;
 }
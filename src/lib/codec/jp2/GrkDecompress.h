@@ -43,6 +43,8 @@ struct DecompressInitParams
 	bool transferExifTags;
 };
 
+class DecompressBatch;
+
 class GrkDecompress
 {
   public:
@@ -56,7 +58,10 @@ class GrkDecompress
 	bool encodeHeader(grk_plugin_decompress_callback_info* info);
 	bool encodeInit(grk_plugin_decompress_callback_info* info);
 	// returns 0 for failure, 1 for success, and 2 if file is not suitable for decoding
-	int decompress(const std::string& fileName, DecompressInitParams* initParams);
+	int decompress(const std::string& fileName, DecompressInitParams* initParams,
+				   grk_decompress_parameters* parameters);
+	// decompress all files in input directory, with several files in flight
+	uint32_t decompressBatch(DecompressInitParams* initParams);
 	int pluginMain(int argc, char** argv, DecompressInitParams* initParams);
 	bool parsePrecision(const char* option, grk_decompress_parameters* parameters);
 	int loadImages(grk_dircnt* dirptr, char* imgdirpath);
@@ -67,9 +72,14 @@ class GrkDecompress
 	void setDefaultParams(grk_decompress_parameters* parameters);
 	void destoryParams(grk_decompress_parameters* parameters);
 	void printTiming(uint32_t num_images, std::chrono::duration<double> elapsed);
+	void releaseBatchMemory(void);
 
 	bool storeToDisk;
 	IImageFormat* imageFormat;
+	// batch that this decompressor belongs to, if any
+	DecompressBatch* batch;
+	// bytes of decompressed image reserved from batch memory budget
+	uint64_t batchBytes;
 };
 
 } // namespace grk
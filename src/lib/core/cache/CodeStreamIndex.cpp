@@ -0,0 +1,273 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+/*
+ Sidecar file layout (all values big endian):
+
+ magic				8 bytes "GRKINDEX"
+ version			uint32
+ stream length		uint64
+ main header hash	uint64
+ number of tile parts	uint32
+	 SOT position	uint64
+	 tile index		uint16
+	 tile part length	uint32
+ number of tiles with packet lengths	uint32
+	 tile index		uint16
+	 number of packets	uint32
+		 packet length	uint32
+ */
+const uint8_t indexMagic[8] = {'G', 'R', 'K', 'I', 'N', 'D', 'E', 'X'};
+const uint32_t indexVersion = 1;
+const size_t indexHeaderBytes = sizeof(indexMagic) + 4 + 8 + 8;
+
+CodeStreamIndex::CodeStreamIndex(const char* path)
+	: path_(path), streamLength_(0), hash_(0), dirty_(false)
+{}
+uint64_t CodeStreamIndex::hash(const uint8_t* data, size_t len)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for(size_t i = 0; i < len; ++i)
+	{
+		h ^= data[i];
+		h *= 0x100000001b3ULL;
+	}
+
+	return h;
+}
+bool CodeStreamIndex::load(uint64_t streamLength, uint64_t hash)
+{
+	streamLength_ = streamLength;
+	hash_ = hash;
+	tileParts_.clear();
+	packetLengths_.clear();
+	dirty_ = false;
+
+	auto fp = fopen(path_.c_str(), "rb");
+	if(!fp)
+		return false;
+	std::vector<uint8_t> data;
+	uint8_t chunk[4096];
+	size_t bytesRead;
+	while((bytesRead = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+		data.insert(data.end(), chunk, chunk + bytesRead);
+	fclose(fp);
+	if(!parse(data.data(), data.size()))
+	{
+		tileParts_.clear();
+		packetLengths_.clear();
+		return false;
+	}
+
+	return true;
+}
+bool CodeStreamIndex::parse(const uint8_t* data, size_t len)
+{
+	if(len < indexHeaderBytes || memcmp(data, indexMagic, sizeof(indexMagic)) != 0)
+	{
+		GRK_WARN("Code stream index %s is corrupt. Ignoring", path_.c_str());
+		return false;
+	}
+	auto end = data + len;
+	data += sizeof(indexMagic);
+	uint32_t version;
+	grk_read<uint32_t>(data, &version);
+	data += 4;
+	if(version != indexVersion)
+	{
+		GRK_WARN("Code stream index %s has unsupported version %u. Ignoring", path_.c_str(),
+				 version);
+		return false;
+	}
+	uint64_t streamLength, hash;
+	grk_read<uint64_t>(data, &streamLength);
+	data += 8;
+	grk_read<uint64_t>(data, &hash);
+	data += 8;
+	if(streamLength != streamLength_ || hash != hash_)
+	{
+		GRK_WARN("Code stream index %s does not match code stream. Ignoring", path_.c_str());
+		return false;
+	}
+	auto canRead = [&data, end](uint64_t bytes) { return (uint64_t)(end - data) >= bytes; };
+	uint32_t numTileParts;
+	if(!canRead(4))
+		goto corrupt;
+	grk_read<uint32_t>(data, &numTileParts);
+	data += 4;
+	if(!canRead((uint64_t)numTileParts * (8 + 2 + 4)))
+		goto corrupt;
+	for(uint32_t i = 0; i < numTileParts; ++i)
+	{
+		uint64_t position;
+		uint16_t tileIndex;
+		uint32_t length;
+		grk_read<uint64_t>(data, &position);
+		data += 8;
+		grk_read<uint16_t>(data, &tileIndex);
+		data += 2;
+		grk_read<uint32_t>(data, &length);
+		data += 4;
+		tileParts_[position] = TilePartLengthInfo(tileIndex, length);
+	}
+	uint32_t numTiles;
+	if(!canRead(4))
+		goto corrupt;
+	grk_read<uint32_t>(data, &numTiles);
+	data += 4;
+	for(uint32_t i = 0; i < numTiles; ++i)
+	{
+		uint16_t tileIndex;
+		uint32_t numPackets;
+		if(!canRead(2 + 4))
+			goto corrupt;
+		grk_read<uint16_t>(data, &tileIndex);
+		data += 2;
+		grk_read<uint32_t>(data, &numPackets);
+		data += 4;
+		if(!canRead((uint64_t)numPackets * 4))
+			goto corrupt;
+		std::vector<uint32_t> lengths(numPackets);
+		for(uint32_t j = 0; j < numPackets; ++j)
+		{
+			grk_read<uint32_t>(data, lengths.data() + j);
+			data += 4;
+		}
+		packetLengths_[tileIndex] = std::move(lengths);
+	}
+
+	return true;
+corrupt:
+	GRK_WARN("Code stream index %s is truncated. Ignoring", path_.c_str());
+
+	return false;
+}
+bool CodeStreamIndex::save(void)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	if(!dirty_)
+		return true;
+	uint64_t len = indexHeaderBytes + 4 + tileParts_.size() * (8 + 2 + 4) + 4;
+	for(auto& p : packetLengths_)
+		len += 2 + 4 + p.second.size() * 4;
+	std::vector<uint8_t> data(len);
+	auto ptr = data.data();
+	memcpy(ptr, indexMagic, sizeof(indexMagic));
+	ptr += sizeof(indexMagic);
+	grk_write<uint32_t>(ptr, indexVersion);
+	ptr += 4;
+	grk_write<uint64_t>(ptr, streamLength_);
+	ptr += 8;
+	grk_write<uint64_t>(ptr, hash_);
+	ptr += 8;
+	grk_write<uint32_t>(ptr, (uint32_t)tileParts_.size());
+	ptr += 4;
+	for(auto& tp : tileParts_)
+	{
+		grk_write<uint64_t>(ptr, tp.first);
+		ptr += 8;
+		grk_write<uint16_t>(ptr, tp.second.tileIndex_);
+		ptr += 2;
+		grk_write<uint32_t>(ptr, tp.second.length_);
+		ptr += 4;
+	}
+	grk_write<uint32_t>(ptr, (uint32_t)packetLengths_.size());
+	ptr += 4;
+	for(auto& p : packetLengths_)
+	{
+		grk_write<uint16_t>(ptr, p.first);
+		ptr += 2;
+		grk_write<uint32_t>(ptr, (uint32_t)p.second.size());
+		ptr += 4;
+		for(auto l : p.second)
+		{
+			grk_write<uint32_t>(ptr, l);
+			ptr += 4;
+		}
+	}
+	assert(ptr == data.data() + len);
+
+	// write to temporary file and rename, so that concurrent readers
+	// never see a partially written index
+	auto tempPath = path_ + ".tmp";
+	auto fp = fopen(tempPath.c_str(), "wb");
+	if(!fp)
+	{
+		GRK_WARN("Unable to create code stream index %s", tempPath.c_str());
+		return false;
+	}
+	bool rc = fwrite(data.data(), 1, data.size(), fp) == data.size();
+	rc = (fclose(fp) == 0) && rc;
+	if(rc)
+		rc = rename(tempPath.c_str(), path_.c_str()) == 0;
+	if(!rc)
+	{
+		GRK_WARN("Unable to write code stream index %s", path_.c_str());
+		remove(tempPath.c_str());
+		return false;
+	}
+	dirty_ = false;
+
+	return true;
+}
+void CodeStreamIndex::pushTilePart(uint64_t position, uint16_t tileIndex, uint32_t length)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto it = tileParts_.find(position);
+	if(it != tileParts_.end() && it->second.tileIndex_ == tileIndex &&
+	   it->second.length_ == length)
+		return;
+	tileParts_[position] = TilePartLengthInfo(tileIndex, length);
+	dirty_ = true;
+}
+TileLengthMarkers* CodeStreamIndex::createTLM(uint64_t position, uint16_t numTiles)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	TileLengthMarkers* tlm = nullptr;
+	for(auto it = tileParts_.find(position); it != tileParts_.end() && it->first == position; ++it)
+	{
+		if(it->second.tileIndex_ >= numTiles)
+			break;
+		if(!tlm)
+			tlm = new TileLengthMarkers(numTiles);
+		tlm->push(it->second.tileIndex_, it->second.length_);
+		position += it->second.length_;
+	}
+
+	return tlm;
+}
+void CodeStreamIndex::setPacketLengths(uint16_t tileIndex, std::vector<uint32_t>&& lengths)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto it = packetLengths_.find(tileIndex);
+	if(it != packetLengths_.end())
+		return;
+	packetLengths_[tileIndex] = std::move(lengths);
+	dirty_ = true;
+}
+const std::vector<uint32_t>* CodeStreamIndex::getPacketLengths(uint16_t tileIndex)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto it = packetLengths_.find(tileIndex);
+
+	return it != packetLengths_.end() ? &it->second : nullptr;
+}
+
+} // namespace grk
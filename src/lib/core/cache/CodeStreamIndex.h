@@ -0,0 +1,102 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+
+namespace grk
+{
+/**
+ * Persistent index of tile part lengths and packet lengths, collected while
+ * decompressing a code stream, and stored in a sidecar file.
+ *
+ * On later opens of the same code stream, the index stands in for missing
+ * TLM and PLT markers : tile parts of non-scheduled tiles are skipped without
+ * reading their SOT markers, and packets outside of the decompress window or
+ * resolution are skipped without parsing their headers.
+ *
+ * The index is keyed by code stream length and a hash of the main header.
+ */
+class CodeStreamIndex
+{
+  public:
+	explicit CodeStreamIndex(const char* path);
+	~CodeStreamIndex() = default;
+	/**
+	 * Load index from sidecar file, if it exists and matches code stream
+	 *
+	 * @param streamLength code stream length
+	 * @param hash hash of code stream main header
+	 * @return true if index was loaded
+	 */
+	bool load(uint64_t streamLength, uint64_t hash);
+	/**
+	 * Save index to sidecar file, if it has changed since it was loaded
+	 *
+	 * @return true if successful
+	 */
+	bool save(void);
+	/**
+	 * Add tile part (thread-safe)
+	 *
+	 * @param position position of tile part SOT marker
+	 * @param tileIndex tile index
+	 * @param length tile part length, including SOT marker
+	 */
+	void pushTilePart(uint64_t position, uint16_t tileIndex, uint32_t length);
+	/**
+	 * Create TLM markers from indexed tile parts that are contiguous with the first tile part
+	 *
+	 * @param position position of first tile part SOT marker
+	 * @param numTiles number of tiles in code stream
+	 * @return TLM markers, or nullptr if first tile part has not been indexed
+	 */
+	TileLengthMarkers* createTLM(uint64_t position, uint16_t numTiles);
+	/**
+	 * Set lengths of all packets of tile, in code stream order (thread-safe)
+	 *
+	 * @param tileIndex tile index
+	 * @param lengths packet lengths
+	 */
+	void setPacketLengths(uint16_t tileIndex, std::vector<uint32_t>&& lengths);
+	/**
+	 * Get lengths of all packets of tile, in code stream order (thread-safe)
+	 *
+	 * @param tileIndex tile index
+	 * @return packet lengths, or nullptr if tile has not been indexed
+	 */
+	const std::vector<uint32_t>* getPacketLengths(uint16_t tileIndex);
+	/**
+	 * FNV-1a hash
+	 */
+	static uint64_t hash(const uint8_t* data, size_t len);
+
+  private:
+	bool parse(const uint8_t* data, size_t len);
+	std::string path_;
+	uint64_t streamLength_;
+	uint64_t hash_;
+	// tile parts, keyed by position of SOT marker
+	std::map<uint64_t, TilePartLengthInfo> tileParts_;
+	std::map<uint16_t, std::vector<uint32_t>> packetLengths_;
+	std::mutex mutex_;
+	bool dirty_;
+};
+
+} // namespace grk
@@ -102,7 +102,11 @@ bool TileInfo::update(uint16_t tileIndex, uint8_t currentTilePart, uint8_t numTi
 			allocatedTileParts *= 2;
 		}
 	}
-	tilePartInfo[currentTilePart] = TilePartInfo(tileIndex, currentTilePart, numTileParts);
+	// positions are filled in as tile part markers are parsed, and are kept
+	// when a tile part is parsed again
+	this->currentTilePart = currentTilePart;
+	if(numTileParts)
+		this->numTileParts = numTileParts;
 
 	return true;
 }
@@ -212,8 +216,12 @@ bool CodeStreamInfo::seekFirstTilePart(uint16_t tileIndex)
 	if(!hasVeryFirstTilePartInfo)
 		return true;
 
+	// if tile has not been parsed yet, then search for it from current position
 	auto tileInfoForTile = getTileInfo(tileIndex);
-	assert(tileInfoForTile && tileInfoForTile->numTileParts);
+	// (start position is only known once tile part has been parsed)
+	if(!tileInfoForTile || !tileInfoForTile->hasTilePartInfo() ||
+	   !tileInfoForTile->getTilePartInfo(0)->startPosition)
+		return true;
 	// move just past SOT marker of first tile part for this tile
 	if(!(stream->seek(tileInfoForTile->getTilePartInfo(0)->startPosition + MARKER_BYTES)))
 	{
@@ -466,6 +474,30 @@ void TileLengthMarkers::seek(TileSet* tilesToDecompress, CodingParams* cp, Buffe
 	if(skip && !stream->seek(stream->tell() + skip))
 		throw CorruptTLMException();
 }
+void TileLengthMarkers::getTilePartRanges(TileSet* tilesToDecompress, uint64_t firstTilePart,
+										   std::vector<grk_stream_range>& ranges)
+{
+	ranges.clear();
+	if(!valid_ || !markers_)
+		return;
+	uint64_t position = firstTilePart;
+	for(auto& m : *markers_)
+	{
+		for(auto& tilePart : *m.second)
+		{
+			if(tilePart.tileIndex_ >= numSignalledTiles_ || tilePart.length_ == 0)
+				return;
+			if(tilesToDecompress->isScheduled(tilePart.tileIndex_))
+			{
+				if(!ranges.empty() && ranges.back().offset + ranges.back().length == position)
+					ranges.back().length += tilePart.length_;
+				else
+					ranges.push_back({position, tilePart.length_});
+			}
+			position += tilePart.length_;
+		}
+	}
+}
 
 bool TileLengthMarkers::writeBegin(uint16_t numTilePartsTotal)
 {
@@ -493,7 +525,8 @@ bool TileLengthMarkers::writeBegin(uint16_t numTilePartsTotal)
 }
 void TileLengthMarkers::push(uint16_t tileIndex, uint32_t tile_part_size)
 {
-	push((uint8_t)markerIt_->first, TilePartLengthInfo(tileIndex, tile_part_size));
+	uint8_t i_TLM = markerIt_ == markers_->end() ? 0 : (uint8_t)markerIt_->first;
+	push(i_TLM, TilePartLengthInfo(tileIndex, tile_part_size));
 }
 bool TileLengthMarkers::writeEnd(void)
 {
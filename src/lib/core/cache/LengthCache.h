@@ -116,6 +116,16 @@ struct TileLengthMarkers
 	void invalidate(void);
 	bool valid(void);
 	void seek(TileSet* tilesToDecompress, CodingParams* cp, BufferedStream* stream);
+	/**
+	 * Get byte ranges of tile parts of scheduled tiles, merging adjacent tile parts.
+	 * Does not change current TLM position
+	 *
+	 * @param tilesToDecompress scheduled tiles
+	 * @param firstTilePart position of first tile part SOT marker
+	 * @param ranges byte ranges, in stream order
+	 */
+	void getTilePartRanges(TileSet* tilesToDecompress, uint64_t firstTilePart,
+						   std::vector<grk_stream_range>& ranges);
 	bool writeBegin(uint16_t numTilePartsTotal);
 	void push(uint16_t tileIndex, uint32_t tile_part_size);
 	bool writeEnd(void);
@@ -73,8 +73,20 @@ bool PLCache::next(PacketInfo** p)
 	return true;
 }
 
+void PLCache::record(uint32_t packetLength)
+{
+	if(cp_->codeStreamIndex_)
+		recordedLengths_.push_back(packetLength);
+}
+void PLCache::commit(uint16_t tileIndex, uint64_t numPackets)
+{
+	if(cp_->codeStreamIndex_ && recordedLengths_.size() == numPackets)
+		cp_->codeStreamIndex_->setPacketLengths(tileIndex, std::move(recordedLengths_));
+	recordedLengths_ = std::vector<uint32_t>();
+}
 void PLCache::rewind(void)
 {
+	recordedLengths_.clear();
 	// we don't currently support PLM markers,
 	// so we disable packet length markers if we have both PLT and PLM
 	if(pltMarkers && !cp_->plm_markers)
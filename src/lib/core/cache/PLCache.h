@@ -32,9 +32,22 @@ class PLCache
 	void deleteMarkers(void);
 	bool next(PacketInfo** p);
 	void rewind(void);
+	/**
+	 * Record length of packet parsed without PL markers, for code stream index
+	 */
+	void record(uint32_t packetLength);
+	/**
+	 * Store recorded packet lengths of tile in code stream index
+	 *
+	 * @param tileIndex tile index
+	 * @param numPackets total number of packets in tile : lengths are only stored
+	 * if all packets have been recorded
+	 */
+	void commit(uint16_t tileIndex, uint64_t numPackets);
 
   private:
 	PLMarkerMgr* pltMarkers;
+	std::vector<uint32_t> recordedLengths_;
 #ifdef ENABLE_PACKET_CACHE
 	SequentialPtrCache<PacketInfo> packetInfoCache;
 #endif
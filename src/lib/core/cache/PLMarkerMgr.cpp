@@ -22,8 +22,8 @@ const uint16_t plWriteBufferLen = USHRT_MAX - 4;
 
 PLMarkerMgr::PLMarkerMgr()
 	: rawMarkers_(new PL_MARKERS()), currMarkerIter_(rawMarkers_->end()), totalBytesWritten_(0),
-	  isFinal_(false), stream_(nullptr), sequential_(false), packetLen_(0), currMarkerBufIndex_(0),
-	  currMarkerBuf_(nullptr), enabled_(true)
+	  isFinal_(false), stream_(nullptr), sequential_(false), nextPacket_(0), indexed_(false),
+	  enabled_(true)
 {}
 // compression
 PLMarkerMgr::PLMarkerMgr(BufferedStream* strm) : PLMarkerMgr()
@@ -54,7 +54,9 @@ void PLMarkerMgr::clearMarkers(void)
 	}
 	rawMarkers_->clear();
 	currMarkerIter_ = rawMarkers_->end();
-	currMarkerBuf_ = nullptr;
+	packetOffsets_.clear();
+	nextPacket_ = 0;
+	indexed_ = false;
 }
 void PLMarkerMgr::pushInit(bool isFinal)
 {
@@ -174,6 +176,7 @@ bool PLMarkerMgr::readPLM(uint8_t* headerData, uint16_t header_size)
 	}
 	if(!findMarker(Zplm, false))
 		return false;
+	indexed_ = false;
 	while(header_size > 0)
 	{
 		// 1. read Nplm
@@ -217,6 +220,7 @@ bool PLMarkerMgr::readPLT(uint8_t* headerData, uint16_t header_size)
 	--header_size;
 	if(!findMarker(Zpl, false))
 		return false;
+	indexed_ = false;
 
 	addNewMarker(headerData, header_size);
 #ifdef DEBUG_PLT
@@ -266,28 +270,68 @@ bool PLMarkerMgr::findMarker(uint32_t nextIndex, bool compress)
 
 	return true;
 }
-bool PLMarkerMgr::readNextByte(uint8_t Iplm, uint32_t* packetLength)
+/*
+ Decode comma-coded packet lengths of all markers, in marker index order,
+ into a table of packet offsets. A packet length may straddle two markers.
+ */
+bool PLMarkerMgr::buildIndex(void)
 {
-	/* take only the lower seven bits */
-	packetLen_ |= (Iplm & 0x7f);
-	if(Iplm & 0x80)
-	{
-		packetLen_ <<= 7;
-	}
-	else
+	packetOffsets_.clear();
+	packetOffsets_.push_back(0);
+	indexed_ = true;
+	uint64_t offset = 0;
+	uint64_t packetLen = 0;
+	for(auto it = rawMarkers_->begin(); it != rawMarkers_->end(); ++it)
 	{
-		if(packetLength)
-			*packetLength = packetLen_;
-		packetLen_ = 0;
+		for(auto b : *it->second)
+		{
+			for(size_t i = 0; i < b->len; ++i)
+			{
+				uint8_t Iplm = b->buf[i];
+				packetLen = (packetLen << 7) | (Iplm & 0x7f);
+				if(Iplm & 0x80)
+				{
+					if(packetLen > (UINT_MAX >> 7))
+					{
+						GRK_ERROR("PLT marker: packet length exceeds 32 bits.");
+						packetOffsets_.resize(1);
+						return false;
+					}
+					continue;
+				}
+				offset += packetLen;
+				packetOffsets_.push_back(offset);
+				packetLen = 0;
+			}
+		}
 	}
+	if(packetLen)
+		GRK_WARN("PLT marker: incomplete final packet length.");
+#ifdef DEBUG_PLT
+	GRK_INFO("Indexed %" PRIu64 " packet lengths", getNumPackets());
+#endif
+
+	return true;
+}
+uint64_t PLMarkerMgr::getNumPackets(void)
+{
+	if(!indexed_)
+		buildIndex();
 
-	return packetLen_ == 0;
+	return packetOffsets_.size() - 1;
 }
 uint64_t PLMarkerMgr::pop(uint64_t numPackets)
 {
-	uint64_t total = 0;
-	for(uint64_t i = 0; i < numPackets; ++i)
-		total += pop();
+	if(!indexed_)
+		buildIndex();
+	if(numPackets > getNumPackets() - nextPacket_)
+	{
+		GRK_ERROR("Attempt to pop PLT beyond PLT marker range.");
+		nextPacket_ = getNumPackets();
+		return 0;
+	}
+	uint64_t total = packetOffsets_[nextPacket_ + numPackets] - packetOffsets_[nextPacket_];
+	nextPacket_ += numPackets;
 
 	return total;
 }
@@ -295,55 +339,26 @@ uint64_t PLMarkerMgr::pop(uint64_t numPackets)
 // no packet length available
 uint32_t PLMarkerMgr::pop(void)
 {
-	uint32_t rc = 0;
-	assert(rawMarkers_);
-
-	if(currMarkerIter_ == rawMarkers_->end())
-	{
-		GRK_ERROR("Attempt to pop PLT beyond PLT marker range.");
-		return 0;
-	}
-	if(currMarkerIter_ != rawMarkers_->end() && currMarkerBuf_)
+	return (uint32_t)pop((uint64_t)1);
+}
+void PLMarkerMgr::setPacketLengths(const std::vector<uint32_t>& lengths)
+{
+	clearMarkers();
+	packetOffsets_.reserve(lengths.size() + 1);
+	packetOffsets_.push_back(0);
+	uint64_t offset = 0;
+	for(auto len : lengths)
 	{
-		// read next packet length
-		while(currMarkerBuf_->canRead() && !readNextByte(currMarkerBuf_->read(), &rc))
-		{}
-		// advance to next buffer
-		if(currMarkerBuf_->offset == currMarkerBuf_->len)
-		{
-			currMarkerBufIndex_++;
-			if(currMarkerBufIndex_ < currMarkerIter_->second->size())
-			{
-				currMarkerBuf_ = currMarkerIter_->second->operator[](currMarkerBufIndex_);
-			}
-			else
-			{
-				currMarkerIter_++;
-				if(currMarkerIter_ != rawMarkers_->end())
-				{
-					currMarkerBufIndex_ = 0;
-					currMarkerBuf_ = currMarkerIter_->second->front();
-				}
-				else
-				{
-					currMarkerBuf_ = nullptr;
-				}
-			}
-		}
+		offset += len;
+		packetOffsets_.push_back(offset);
 	}
-
-	// static int count = 0;
-	// GRK_INFO("Read PLT packet %u, length %u", count++,rc);
-	return rc;
+	indexed_ = true;
 }
-
 void PLMarkerMgr::rewind(void)
 {
-	if(!rawMarkers_->empty())
-	{
-		currMarkerIter_ = rawMarkers_->begin();
-		currMarkerBuf_ = currMarkerIter_->second->front();
-	}
+	if(!indexed_)
+		buildIndex();
+	nextPacket_ = 0;
 }
 
 } // namespace grk
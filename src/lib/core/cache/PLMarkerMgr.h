@@ -47,9 +47,33 @@ struct PLMarkerMgr
 	PLMarkerMgr(BufferedStream* strm);
 	bool readPLT(uint8_t* headerData, uint16_t header_size);
 	bool readPLM(uint8_t* headerData, uint16_t header_size);
+	/**
+	 * Rewind to first packet, indexing packet lengths if markers have changed
+	 */
 	void rewind(void);
+	/**
+	 * Pop length of next packet
+	 *
+	 * @return packet length, or 0 if no more packet lengths are available
+	 */
 	uint32_t pop(void);
+	/**
+	 * Pop total length of next numPackets packets, in constant time
+	 *
+	 * @param numPackets number of packets
+	 * @return total length, or 0 if there are fewer than numPackets packet lengths available
+	 */
 	uint64_t pop(uint64_t numPackets);
+	/**
+	 * Get number of indexed packets
+	 */
+	uint64_t getNumPackets(void);
+	/**
+	 * Index packet lengths that were not read from PL markers
+	 *
+	 * @param lengths packet lengths, in code stream order
+	 */
+	void setPacketLengths(const std::vector<uint32_t>& lengths);
 	////////////////////////////////////////////
   private:
 	void clearMarkers(void);
@@ -67,11 +91,14 @@ struct PLMarkerMgr
 
 	//////////////////////////
 	// decompress
-	bool readNextByte(uint8_t Iplm, uint32_t* packetLength);
+	bool buildIndex(void);
 	bool sequential_;
-	uint32_t packetLen_;
-	uint32_t currMarkerBufIndex_;
-	grk_buf8* currMarkerBuf_;
+	// packetOffsets_[i] is offset of packet i from start of tile data,
+	// and final entry is total length of all packets
+	std::vector<uint64_t> packetOffsets_;
+	// index of next packet to pop
+	uint64_t nextPacket_;
+	bool indexed_;
 	///////////////////////////////
 
 	bool enabled_;
@@ -14,14 +14,31 @@ static bool grkReclaimCallback(uint32_t threadId, grk_io_buf buffer, void* io_us
 }
 
 Strip::Strip(GrkImage* outputImage, uint16_t index, uint32_t nominalHeight, uint8_t reduce)
-	: stripImg(new GrkImage()), tileCounter(0), reduce_(reduce), allocatedInterleaved_(false)
+	: stripImg(new GrkImage()), tileCounter(0), compCounter(0), reduce_(reduce),
+	  allocatedInterleaved_(false)
 {
 	outputImage->copyHeader(stripImg);
 
-	stripImg->y0 = outputImage->y0 + index * nominalHeight;
-	stripImg->y1 = std::min<uint32_t>(outputImage->y1, stripImg->y0 + nominalHeight);
-	stripImg->comps->y0 = reduceDim(stripImg->y0);
-	stripImg->comps->h = reduceDim(stripImg->y1 - stripImg->y0);
+	if(outputImage->hasMultipleTiles)
+	{
+		// strips are aligned with tile rows, so nominal height is on the reference grid
+		stripImg->y0 = outputImage->y0 + index * nominalHeight;
+		stripImg->y1 = std::min<uint32_t>(outputImage->y1, stripImg->y0 + nominalHeight);
+		stripImg->comps->y0 = reduceDim(stripImg->y0);
+		stripImg->comps->h = reduceDim(stripImg->y1 - stripImg->y0);
+	}
+	else
+	{
+		// strips are ingested from rows of the (reduced) tile, so nominal height
+		// is in reduced rows
+		auto comp = outputImage->comps;
+		uint32_t offset = index * nominalHeight;
+		stripImg->comps->y0 = comp->y0 + offset;
+		stripImg->comps->h = std::min<uint32_t>(nominalHeight, comp->h - offset);
+		stripImg->y0 = std::min<uint32_t>(outputImage->y1, outputImage->y0 + (offset << reduce));
+		stripImg->y1 = std::min<uint32_t>(outputImage->y1,
+										  stripImg->y0 + (stripImg->comps->h << reduce));
+	}
 }
 Strip::~Strip(void)
 {
@@ -100,7 +117,8 @@ void StripCache::init(uint32_t concurrency, uint16_t numTiles, uint32_t numStrip
 	for(uint32_t i = 0; i < concurrency; ++i)
 		pools_.push_back(new BufPool());
 }
-bool StripCache::ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd)
+bool StripCache::ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd,
+							 uint16_t numComps)
 {
 	if(!initialized_)
 		return false;
@@ -108,6 +126,9 @@ bool StripCache::ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint
 	uint16_t stripId = (uint16_t)((yBegin + nominalStripHeight_ - 1) / nominalStripHeight_);
 	assert(stripId < numStrips_);
 	auto strip = strips[stripId];
+	// wait until all components of this strip have been transformed
+	if((strip->compCounter += numComps) < src->numcomps_)
+		return true;
 	auto dest = strip->stripImg;
 	// use height of first component, because no subsampling
 	uint64_t dataLen = packedRowBytes_ * (yEnd - yBegin);
@@ -170,6 +191,7 @@ bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 		return ioBufferCallback_(threadId, buf, ioUserData_);
 
 	std::queue<GrkIOBuf> buffersToSerialize;
+	std::unique_lock<std::mutex> serializeLock(serializeMutex_, std::defer_lock);
 	{
 		std::unique_lock<std::mutex> lk(heapMutex_);
 		// 1. push to heap
@@ -181,20 +203,22 @@ bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 			buffersToSerialize.push(buf);
 			buf = serializeHeap.pop();
 		}
+		// acquire serialize lock before releasing heap lock, so that
+		// sequential buffers popped by different threads are serialized in order
+		if(!buffersToSerialize.empty())
+			serializeLock.lock();
 	}
 	// 3. serialize buffers
 	if(!buffersToSerialize.empty())
 	{
+		while(!buffersToSerialize.empty())
 		{
-			std::unique_lock<std::mutex> lk(serializeMutex_);
-			while(!buffersToSerialize.empty())
-			{
-				auto b = buffersToSerialize.front();
-				if(!ioBufferCallback_(threadId, b, ioUserData_))
-					break;
-				buffersToSerialize.pop();
-			}
+			auto b = buffersToSerialize.front();
+			if(!ioBufferCallback_(threadId, b, ioUserData_))
+				break;
+			buffersToSerialize.pop();
 		}
+		serializeLock.unlock();
 		// if non empty, then there has been a serialize failure
 		if(!buffersToSerialize.empty())
 		{
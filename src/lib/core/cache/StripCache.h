@@ -101,6 +101,7 @@ struct Strip
 	bool allocInterleaved(uint64_t len, BufPool* pool);
 	GrkImage* stripImg;
 	std::atomic<uint32_t> tileCounter; // count number of tiles added to strip
+	std::atomic<uint16_t> compCounter; // count number of components completed in strip
 	uint8_t reduce_; // resolution reduction
 	mutable std::mutex interleaveMutex_;
 	mutable std::atomic<bool> allocatedInterleaved_;
@@ -118,7 +119,12 @@ class StripCache
 			  grk_io_register_reclaim_callback grkRegisterReclaimCallback);
 	bool ingestTile(uint32_t threadId, GrkImage* src);
 	bool ingestTile(GrkImage* src);
-	bool ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd);
+	/**
+	 * Ingest rows [yBegin, yEnd) of a single-tile image, for numComps components.
+	 * Strip is interleaved and serialized once all tile components have been ingested.
+	 */
+	bool ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd,
+					 uint16_t numComps);
 	void returnBufferToPool(uint32_t threadId, GrkIOBuf b);
 	bool isInitialized(void);
 	bool isMultiTile(void);
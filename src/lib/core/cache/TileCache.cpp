@@ -18,13 +18,15 @@
 
 namespace grk
 {
-TileCacheEntry::TileCacheEntry(TileProcessor* p) : processor(p) {}
+TileCacheEntry::TileCacheEntry(TileProcessor* p) : processor(p), bytes(0), inLRU(false) {}
 TileCacheEntry::TileCacheEntry() : TileCacheEntry(nullptr) {}
 TileCacheEntry::~TileCacheEntry()
 {
 	delete processor;
 }
-TileCache::TileCache(GRK_TILE_CACHE_STRATEGY strategy) : tileComposite(nullptr), strategy_(strategy)
+TileCache::TileCache(GRK_TILE_CACHE_STRATEGY strategy)
+	: tileComposite(nullptr), strategy_(strategy), maxBytes_(0), bytes_(0), hits_(0),
+	  codeBlockHits_(0), misses_(0), evictions_(0)
 {
 	tileComposite = new GrkImage();
 }
@@ -42,6 +44,7 @@ bool TileCache::empty()
 }
 TileCacheEntry* TileCache::put(uint16_t tileIndex, TileProcessor* processor)
 {
+	std::unique_lock<std::mutex> lk(mutex_);
 	TileCacheEntry* entry = nullptr;
 	if(cache_.find(tileIndex) != cache_.end())
 	{
@@ -58,15 +61,72 @@ TileCacheEntry* TileCache::put(uint16_t tileIndex, TileProcessor* processor)
 }
 TileCacheEntry* TileCache::get(uint16_t tileIndex)
 {
-	if(cache_.find(tileIndex) != cache_.end())
-		return cache_[tileIndex];
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto it = cache_.find(tileIndex);
 
-	return nullptr;
+	return it != cache_.end() ? it->second : nullptr;
+}
+void TileCache::touch(uint16_t tileIndex)
+{
+	if(strategy_ != GRK_TILE_CACHE_LRU)
+		return;
+	std::unique_lock<std::mutex> lk(mutex_);
+	auto it = cache_.find(tileIndex);
+	if(it == cache_.end())
+		return;
+	auto entry = it->second;
+	if(entry->inLRU)
+	{
+		lru_.erase(entry->lruIt);
+		bytes_ -= entry->bytes;
+	}
+	entry->bytes = entry->processor ? entry->processor->getCachedBytes() : 0;
+	bytes_ += entry->bytes;
+	entry->lruIt = lru_.insert(lru_.end(), tileIndex);
+	entry->inLRU = true;
+	if(!maxBytes_)
+		return;
+	// evict least recently used tiles, but never the tile just touched
+	while(bytes_ > maxBytes_ && lru_.front() != tileIndex)
+	{
+		auto evicted = cache_[lru_.front()];
+		lru_.pop_front();
+		evicted->inLRU = false;
+		bytes_ -= evicted->bytes;
+		evicted->bytes = 0;
+		evicted->processor->evict();
+		evictions_++;
+	}
+}
+void TileCache::countHit(bool codeBlocks)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	hits_++;
+	if(codeBlocks)
+		codeBlockHits_++;
+}
+void TileCache::countMiss(void)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	misses_++;
+}
+void TileCache::getStats(grk_tile_cache_stats* stats)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	stats->hits = hits_;
+	stats->codeBlockHits = codeBlockHits_;
+	stats->misses = misses_;
+	stats->evictions = evictions_;
+	stats->bytes = bytes_;
 }
 void TileCache::setStrategy(GRK_TILE_CACHE_STRATEGY strategy)
 {
 	strategy_ = strategy;
 }
+void TileCache::setMaxBytes(uint64_t maxBytes)
+{
+	maxBytes_ = maxBytes;
+}
 GRK_TILE_CACHE_STRATEGY TileCache::getStrategy(void)
 {
 	return strategy_;
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <map>
+#include <list>
+#include <mutex>
 
 namespace grk
 {
@@ -32,6 +34,11 @@ struct TileCacheEntry
 	~TileCacheEntry();
 
 	TileProcessor* processor;
+	// approximate number of cached bytes, for LRU strategy
+	uint64_t bytes;
+	// position in LRU list, if bytes are accounted for
+	std::list<uint16_t>::iterator lruIt;
+	bool inLRU;
 };
 
 class TileCache
@@ -44,8 +51,33 @@ class TileCache
 	bool empty(void);
 	void setStrategy(GRK_TILE_CACHE_STRATEGY strategy);
 	GRK_TILE_CACHE_STRATEGY getStrategy(void);
+	/**
+	 * Set byte budget for LRU strategy
+	 *
+	 * @param maxBytes maximum number of cached bytes, or zero for no limit
+	 */
+	void setMaxBytes(uint64_t maxBytes);
 	TileCacheEntry* put(uint16_t tileIndex, TileProcessor* processor);
 	TileCacheEntry* get(uint16_t tileIndex);
+	/**
+	 * For LRU strategy, mark tile as most recently used, update its byte count,
+	 * and evict least recently used tiles until cache is within byte budget
+	 * (thread-safe)
+	 *
+	 * @param tileIndex tile index
+	 */
+	void touch(uint16_t tileIndex);
+	/**
+	 * Count tile request served from cache
+	 *
+	 * @param codeBlocks true if tile was decompressed again from cached code blocks
+	 */
+	void countHit(bool codeBlocks);
+	/**
+	 * Count tile request that required reading tile from code stream
+	 */
+	void countMiss(void);
+	void getStats(grk_tile_cache_stats* stats);
 	GrkImage* getComposite(void);
 	std::vector<GrkImage*> getAllImages(void);
 	std::vector<GrkImage*> getTileImages(void);
@@ -55,6 +87,15 @@ class TileCache
 	GrkImage* tileComposite;
 	std::map<uint32_t, TileCacheEntry*> cache_;
 	GRK_TILE_CACHE_STRATEGY strategy_;
+	// tile indices, from least to most recently used
+	std::list<uint16_t> lru_;
+	uint64_t maxBytes_;
+	uint64_t bytes_;
+	uint64_t hits_;
+	uint64_t codeBlockHits_;
+	uint64_t misses_;
+	uint64_t evictions_;
+	std::mutex mutex_;
 };
 
 } // namespace grk
@@ -122,6 +122,7 @@ struct ICodeStreamDecompress
 	virtual bool setDecompressRegion(grk_rect_single region) = 0;
 	virtual bool decompress(grk_plugin_tile* tile) = 0;
 	virtual bool decompressTile(uint16_t tileIndex) = 0;
+	virtual void getTileCacheStats(grk_tile_cache_stats* stats) = 0;
 	virtual bool preProcess(void) = 0;
 	virtual bool postProcess(void) = 0;
 	virtual void dump(uint32_t flag, FILE* outputFileStream) = 0;
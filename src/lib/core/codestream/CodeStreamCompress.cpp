@@ -168,13 +168,19 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 
 	if(isHT)
 	{
-		if(parameters->numlayers > 1 || parameters->layer_rate[0] != 0)
+		// HT code blocks have a single cleanup pass, so rate control
+		// can only form a single layer
+		if(parameters->numlayers > 1)
 		{
-			GRK_WARN("Rate control not supported for HTJ2K compression.");
+			GRK_WARN("Multiple quality layers not supported for HTJ2K compression. "
+					 "Using final layer only.");
+			parameters->layer_rate[0] = parameters->layer_rate[parameters->numlayers - 1];
+			parameters->layer_distortion[0] =
+				parameters->layer_distortion[parameters->numlayers - 1];
 			parameters->numlayers = 1;
-			parameters->layer_rate[0] = 0;
 		}
-		parameters->allocationByRateDistoration = true;
+		if(!parameters->allocationByQuality)
+			parameters->allocationByRateDistoration = true;
 	}
 
 	if((parameters->numresolution == 0) || (parameters->numresolution > GRK_J2K_MAXRLVLS))
@@ -307,6 +313,8 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 	cp_.coding_params_.enc_.writePLT = parameters->writePLT;
 	cp_.coding_params_.enc_.writeTLM = parameters->writeTLM;
 	cp_.coding_params_.enc_.rateControlAlgorithm = parameters->rateControlAlgorithm;
+	cp_.coding_params_.enc_.maxTilesInFlight = parameters->maxTilesInFlight;
+	cp_.coding_params_.enc_.htEncoder = parameters->htEncoder;
 
 	/* tiles */
 	cp_.t_width = parameters->t_width;
@@ -634,27 +642,55 @@ uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
 	std::atomic<bool> success(true);
 	if(numRequiredThreads > 1)
 	{
-		tf::Executor exec(numRequiredThreads);
-		tf::Taskflow taskflow;
-		auto node = new tf::Task[numTiles];
-		for(uint64_t i = 0; i < numTiles; i++)
-			node[i] = taskflow.placeholder();
+		// Tiles are compressed concurrently and written to the code stream in order:
+		// tile N is flushed as soon as tiles 0..N have been compressed.
+		// A tile is only scheduled once it lies within maxTilesInFlight
+		// of the next tile to be written, which bounds memory usage
+		uint32_t maxTilesInFlight = cp_.coding_params_.enc_.maxTilesInFlight;
+		if(maxTilesInFlight == 0)
+			maxTilesInFlight = 2 * numRequiredThreads;
+		std::mutex writeMutex;
+		std::condition_variable tileWritten;
+		uint32_t numTilesScheduled = 0;
+		uint32_t numTilesWritten = 0;
+		// number of tile tasks that no longer touch any state local to this method
+		uint32_t numTilesCompleted = 0;
+		auto flush = [this, &heap, &success, &writeMutex, &tileWritten, &numTilesWritten,
+					  &numTilesCompleted]() {
+			std::unique_lock<std::mutex> lk(writeMutex);
+			numTilesCompleted++;
+			auto completeTileProcessor = heap.pop();
+			while(completeTileProcessor)
+			{
+				if(success && !writeTileParts(completeTileProcessor))
+					success = false;
+				delete completeTileProcessor;
+				numTilesWritten++;
+				completeTileProcessor = heap.pop();
+			}
+			tileWritten.notify_all();
+		};
 		for(uint16_t j = 0; j < numTiles; ++j)
 		{
+			ExecSingleton::wait_until(writeMutex, tileWritten, [&] {
+				return !success || j < numTilesWritten + maxTilesInFlight;
+			});
+			if(!success)
+				break;
 			uint16_t tileIndex = j;
-			node[j].work([this, tile, tileIndex, &heap, &success] {
-				if(success)
-				{
-					auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
-					tileProcessor->current_plugin_tile = tile;
-					if(!tileProcessor->preCompressTile() || !tileProcessor->doCompress())
-						success = false;
-					heap.push(tileProcessor);
-				}
+			numTilesScheduled++;
+			ExecSingleton::get()->silent_async([this, tile, tileIndex, &heap, &success, &flush] {
+				// tile processor is always pushed, so that tiles are flushed without gaps
+				auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
+				tileProcessor->current_plugin_tile = tile;
+				if(success && (!tileProcessor->preCompressTile() || !tileProcessor->doCompress()))
+					success = false;
+				heap.push(tileProcessor);
+				flush();
 			});
 		}
-		exec.run(taskflow).wait();
-		delete[] node;
+		ExecSingleton::wait_until(writeMutex, tileWritten,
+								  [&] { return numTilesCompleted == numTilesScheduled; });
 	}
 	else
 	{
@@ -26,8 +26,8 @@ namespace grk
 CodeStreamDecompress::CodeStreamDecompress(BufferedStream* stream)
 	: CodeStream(stream), expectSOD_(false), curr_marker_(0), headerError_(false),
 	  headerRead_(false), marker_scratch_(nullptr), marker_scratch_size_(0), outputImage_(nullptr),
-	  tileCache_(new TileCache()), ioBufferCallback(nullptr), ioUserData(nullptr),
-	  grkRegisterReclaimCallback_(nullptr)
+	  decompressRegion_(0, 0, 0, 0), tileCache_(new TileCache()), ioBufferCallback(nullptr),
+	  ioUserData(nullptr), grkRegisterReclaimCallback_(nullptr)
 {
 	decompressorState_.default_tcp_ = new TileCodingParams();
 	decompressorState_.lastSotReadPosition = 0;
@@ -107,6 +107,8 @@ CodeStreamDecompress::~CodeStreamDecompress()
 	if(outputImage_)
 		grk_object_unref(&outputImage_->obj);
 	delete tileCache_;
+	if(cp_.codeStreamIndex_)
+		cp_.codeStreamIndex_->save();
 }
 bool CodeStreamDecompress::needsHeaderRead(void)
 {
@@ -155,6 +157,10 @@ GrkImage* CodeStreamDecompress::getImage(uint16_t tileIndex)
 	auto entry = tileCache_->get(tileIndex);
 	return entry ? entry->processor->getImage() : nullptr;
 }
+void CodeStreamDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	tileCache_->getStats(stats);
+}
 std::vector<GrkImage*> CodeStreamDecompress::getAllImages(void)
 {
 	return tileCache_->getAllImages();
@@ -247,8 +253,9 @@ bool CodeStreamDecompress::setDecompressRegion(grk_rect_single region)
 	auto compositeImage = getCompositeImage();
 	auto decompressor = &decompressorState_;
 
-	/* Check if we have read the main header */
-	if(decompressor->getState() != DECOMPRESS_STATE_TPH_SOT)
+	/* Check if we have read the main header.
+	 * Region may also be changed between decompressions of single tiles */
+	if(decompressor->getState() != DECOMPRESS_STATE_TPH_SOT && !outputImage_)
 	{
 		GRK_ERROR("Need to read the main header before setting decompress region");
 		return false;
@@ -328,6 +335,8 @@ bool CodeStreamDecompress::setDecompressRegion(grk_rect_single region)
 			compositeImage->y1 = end_y;
 		}
 		decompressor->tilesToDecompress_.schedule(tilesToDecompress);
+		decompressRegion_ =
+			grk_rect32(compositeImage->x0, compositeImage->y0, compositeImage->x1, compositeImage->y1);
 		cp_.wholeTileDecompress_ = false;
 		if(!compositeImage->subsampleAndReduce(cp_.coding_params_.dec_.reduce_))
 			return false;
@@ -357,7 +366,16 @@ void CodeStreamDecompress::init(grk_decompress_core_params* parameters)
 	cp_.coding_params_.dec_.layer_ = parameters->max_layers;
 	cp_.coding_params_.dec_.reduce_ = parameters->reduce;
 	cp_.coding_params_.dec_.randomAccessFlags_ = parameters->randomAccessFlags_;
+	cp_.coding_params_.dec_.htDecoder_ = parameters->htDecoder;
 	tileCache_->setStrategy(parameters->tileCacheStrategy);
+	tileCache_->setMaxBytes(parameters->tileCacheBytes);
+	cp_.coding_params_.dec_.tileCacheCodeBlocks_ =
+		parameters->tileCacheStrategy == GRK_TILE_CACHE_LRU && parameters->tileCacheCodeBlocks;
+	if(parameters->index_file && parameters->index_file[0])
+	{
+		delete cp_.codeStreamIndex_;
+		cp_.codeStreamIndex_ = new CodeStreamIndex(parameters->index_file);
+	}
 
 	ioBufferCallback = parameters->io_buffer_callback;
 	ioUserData = parameters->io_user_data;
@@ -373,8 +391,10 @@ bool CodeStreamDecompress::decompress(grk_plugin_tile* tile)
 bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 {
 	// 1. check if tile has already been decompressed
+	// (LRU cache checks image bounds below)
+	bool lru = tileCache_->getStrategy() == GRK_TILE_CACHE_LRU;
 	auto entry = tileCache_->get(tileIndex);
-	if(entry && entry->processor && entry->processor->getImage())
+	if(!lru && entry && entry->processor && entry->processor->getImage())
 		return true;
 
 	// 2. otherwise, decompress tile
@@ -382,6 +402,14 @@ bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 	{
 		/* Copy code stream image information to composite image */
 		headerImage_->copyHeader(getCompositeImage());
+		if(!decompressRegion_.empty())
+		{
+			auto compositeImage = getCompositeImage();
+			compositeImage->x0 = decompressRegion_.x0;
+			compositeImage->y0 = decompressRegion_.y0;
+			compositeImage->x1 = decompressRegion_.x1;
+			compositeImage->y1 = decompressRegion_.y1;
+		}
 	}
 	uint16_t numTilesToDecompress = (uint16_t)(cp_.t_grid_width * cp_.t_grid_height);
 	if(codeStreamInfo && !codeStreamInfo->allocTileInfo(numTilesToDecompress))
@@ -434,6 +462,31 @@ bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 		comp->h = reducedCompBounds.height();
 	}
 	compositeImage->postReadHeader(&cp_);
+
+	// 3. LRU cache: serve tile from cached image, if it was decompressed with same bounds
+	auto cachedImage = (lru && entry && entry->processor) ? entry->processor->getImage() : nullptr;
+	if(cachedImage && cachedImage->numcomps == compositeImage->numcomps)
+	{
+		bool sameBounds = true;
+		for(uint16_t compno = 0; compno < compositeImage->numcomps; ++compno)
+		{
+			auto comp = compositeImage->comps + compno;
+			auto cachedComp = cachedImage->comps + compno;
+			if(comp->x0 != cachedComp->x0 || comp->y0 != cachedComp->y0 ||
+			   comp->w != cachedComp->w || comp->h != cachedComp->h)
+			{
+				sameBounds = false;
+				break;
+			}
+		}
+		if(sameBounds && cachedImage->copyDataTo(compositeImage))
+		{
+			tileCache_->countHit(false);
+			tileCache_->touch(tileIndex);
+
+			return true;
+		}
+	}
 	decompressorState_.tilesToDecompress_.schedule(tileIndex);
 
 	// reset tile part numbers, in case we are re-using the same codec object
@@ -461,6 +514,7 @@ bool CodeStreamDecompress::decompressTiles(void)
 	}
 	if(!createOutputImage())
 		return false;
+	prefetchTileParts();
 
 	auto numRequiredThreads =
 		std::min<uint32_t>((uint32_t)ExecSingleton::get()->num_workers(), numTilesToDecompress);
@@ -469,8 +523,10 @@ bool CodeStreamDecompress::decompressTiles(void)
 		uint32_t numStrips = cp_.t_grid_height;
 		if(numTilesToDecompress == 1)
 		{
-			numStrips = (outputImage_->height() + outputImage_->rowsPerStrip - 1) /
-						outputImage_->rowsPerStrip;
+			// single tile strips are in reduced rows
+			uint32_t height =
+				outputImage_->hasMultipleTiles ? outputImage_->height() : outputImage_->comps->h;
+			numStrips = (height + outputImage_->rowsPerStrip - 1) / outputImage_->rowsPerStrip;
 		}
 		stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), cp_.t_grid_width, numStrips,
 						 numTilesToDecompress > 1 ? cp_.t_height : outputImage_->rowsPerStrip,
@@ -481,12 +537,10 @@ bool CodeStreamDecompress::decompressTiles(void)
 	std::atomic<bool> success(true);
 	std::atomic<uint32_t> numTilesDecompressed(0);
 
-	tf::Executor* executor = nullptr;
 	tf::Task* node = nullptr;
 	tf::Taskflow taskflow;
 	if(numRequiredThreads > 1)
 	{
-		executor = new tf::Executor(numRequiredThreads);
 		node = new tf::Task[numTilesToDecompress];
 		for(uint64_t i = 0; i < numTilesToDecompress; i++)
 			node[i] = taskflow.placeholder();
@@ -539,7 +593,7 @@ bool CodeStreamDecompress::decompressTiles(void)
 		// 3. T2 + T1 decompress
 		// once we schedule a processor for T1 compression, we will destroy it
 		// regardless of success or not
-		auto exec = [this, executor, processor, numTilesToDecompress, &numTilesDecompressed,
+		auto exec = [this, node, processor, numTilesToDecompress, &numTilesDecompressed,
 					 &success] {
 			if(success)
 			{
@@ -557,12 +611,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 					{
 						if(outputImage_->supportsStripCache(&cp_))
 						{
-							if(executor)
+							if(node)
 							{
-								uint32_t threadId = executor->num_workers() > 1
-														? (uint32_t)executor->this_worker_id()
-														: 0;
-								if(!stripCache_.ingestTile(threadId, img))
+								if(!stripCache_.ingestTile(ExecSingleton::threadId(), img))
 									success = false;
 							}
 							else
@@ -578,6 +629,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 						}
 					}
 					processor->release(success ? tileCache_->getStrategy() : GRK_TILE_CACHE_NONE);
+					tileCache_->countMiss();
+					if(success)
+						tileCache_->touch(processor->getIndex());
 				}
 			}
 			return 0;
@@ -605,11 +659,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 			break;
 		}
 	}
-	if(executor)
+	if(node)
 	{
-		executor->run(taskflow).wait();
-		delete executor;
-		executor = nullptr;
+		ExecSingleton::run(taskflow);
 		delete[] node;
 		node = nullptr;
 	}
@@ -629,10 +681,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 		GRK_WARN("Only %u out of %u tiles were decompressed", decompressed, numTilesToDecompress);
 	}
 cleanup:
-	if(executor)
+	if(node)
 	{
-		executor->run(taskflow).wait();
-		delete executor;
+		ExecSingleton::run(taskflow);
 		delete[] node;
 	}
 	return success;
@@ -773,6 +824,8 @@ bool CodeStreamDecompress::readHeaderProcedureImpl(void)
 	// subtract bytes for already-read SOT marker
 	if(codeStreamInfo)
 		codeStreamInfo->setMainHeaderEnd(stream_->tell() - MARKER_BYTES);
+	if(!loadIndex())
+		return false;
 
 	// rewind TLM marker if present
 	if(cp_.tlm_markers)
@@ -810,6 +863,41 @@ bool CodeStreamDecompress::createOutputImage(void)
 
 	return outputImage_->supportsStripCache(&cp_) || outputImage_->allocCompositeData();
 }
+/***
+ * Load persistent code stream index, which stands in for missing TLM markers
+ */
+bool CodeStreamDecompress::loadIndex(void)
+{
+	auto index = cp_.codeStreamIndex_;
+	if(!index)
+		return true;
+	if(!stream_->hasSeek())
+	{
+		GRK_WARN("Code stream index requires a seekable stream. Disabling index");
+		delete index;
+		cp_.codeStreamIndex_ = nullptr;
+		return true;
+	}
+	// index is keyed by code stream length and main header hash
+	uint64_t position = stream_->tell();
+	uint64_t headerStart = codeStreamInfo->getMainHeaderStart();
+	uint64_t headerEnd = codeStreamInfo->getMainHeaderEnd();
+	size_t headerLength = (size_t)(headerEnd - headerStart);
+	std::unique_ptr<uint8_t[]> header(new uint8_t[headerLength]);
+	if(!stream_->seek(headerStart) || stream_->read(header.get(), headerLength) != headerLength ||
+	   !stream_->seek(position))
+	{
+		GRK_ERROR("Unable to read main header for code stream index");
+		return false;
+	}
+	index->load(position + stream_->numBytesLeft(),
+				CodeStreamIndex::hash(header.get(), headerLength));
+	if(!cp_.tlm_markers && (cp_.coding_params_.dec_.randomAccessFlags_ & GRK_RANDOM_ACCESS_TLM))
+		cp_.tlm_markers =
+			index->createTLM(headerEnd, (uint16_t)(cp_.t_grid_width * cp_.t_grid_height));
+
+	return true;
+}
 bool CodeStreamDecompress::hasTLM(void)
 {
 	return cp_.tlm_markers && cp_.tlm_markers->valid();
@@ -826,12 +914,28 @@ bool CodeStreamDecompress::skipNonScheduledTLM(CodingParams* cp)
 
 	return true;
 }
+/***
+ * Notify client of byte ranges of scheduled tile parts
+ */
+void CodeStreamDecompress::prefetchTileParts(void)
+{
+	if(!stream_->hasPrefetch() || !hasTLM() || !codeStreamInfo)
+		return;
+	std::vector<grk_stream_range> ranges;
+	cp_.tlm_markers->getTilePartRanges(&decompressorState_.tilesToDecompress_,
+									   codeStreamInfo->getMainHeaderEnd(), ranges);
+	stream_->prefetch(ranges);
+}
 
 /*
  * Read and decompress one tile.
  */
 bool CodeStreamDecompress::decompressTile(void)
 {
+	// bounds of single tile output image change from one tile to the next
+	if(outputImage_)
+		grk_object_unref(&outputImage_->obj);
+	outputImage_ = nullptr;
 	if(!createOutputImage())
 		return false;
 	if(decompressorState_.tilesToDecompress_.numScheduled() != 1)
@@ -844,8 +948,20 @@ bool CodeStreamDecompress::decompressTile(void)
 	uint16_t tileIndex = decompressorState_.tilesToDecompress_.getSingle();
 	auto tileCache = tileCache_->get(tileIndex);
 	auto tileProcessor = tileCache ? tileCache->processor : nullptr;
-	if(!tileCache || !tileCache->processor->getImage())
+	bool reuseCodeBlocks = tileProcessor && tileProcessor->hasCachedCodeBlocks();
+	if(reuseCodeBlocks)
 	{
+		tileCache_->countHit(true);
+	}
+	else
+	{
+		tileCache_->countMiss();
+		// tile may have been decompressed before : release it, and read it again
+		if(tileProcessor)
+			tileProcessor->evict();
+		if(!rewindToFirstTilePart())
+			return false;
+		prefetchTileParts();
 		// find first tile part
 		try
 		{
@@ -880,21 +996,24 @@ bool CodeStreamDecompress::decompressTile(void)
 			return false;
 		}
 		tileProcessor = currentTileProcessor_;
-		if(outputImage_->supportsStripCache(&cp_))
-		{
-			uint32_t numStrips = (outputImage_->height() + outputImage_->rowsPerStrip - 1) /
-								 outputImage_->rowsPerStrip;
-			stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), 1, numStrips,
-							 outputImage_->rowsPerStrip, cp_.coding_params_.dec_.reduce_,
-							 outputImage_, ioBufferCallback, ioUserData,
-							 grkRegisterReclaimCallback_);
-		}
+	}
+	if(outputImage_->supportsStripCache(&cp_))
+	{
+		// single tile strips are in reduced rows
+		uint32_t numStrips =
+			(outputImage_->comps->h + outputImage_->rowsPerStrip - 1) / outputImage_->rowsPerStrip;
+		stripCache_.init((uint32_t)ExecSingleton::get()->num_workers(), 1, numStrips,
+						 outputImage_->rowsPerStrip, cp_.coding_params_.dec_.reduce_, outputImage_,
+						 ioBufferCallback, ioUserData, grkRegisterReclaimCallback_);
+	}
 
-		if(!tileProcessor->decompressT2T1(outputImage_))
-			return false;
+	if(!tileProcessor->decompressT2T1(outputImage_))
+		return false;
 
-		// check for corrupt Adobe images where a final tile part is not parsed
-		// due to incorrectly-signalled number of tile parts
+	// check for corrupt Adobe images where a final tile part is not parsed
+	// due to incorrectly-signalled number of tile parts
+	if(!reuseCodeBlocks)
+	{
 		try
 		{
 			if(readSOTorEOC() && curr_marker_ == J2K_MS_SOT)
@@ -909,6 +1028,32 @@ bool CodeStreamDecompress::decompressTile(void)
 			return false;
 		}
 	}
+	if(tileCache_->getStrategy() == GRK_TILE_CACHE_LRU)
+	{
+		// image is not cached when strips are written directly to client
+		tileProcessor->cacheImage(outputImage_);
+		tileCache_->touch(tileIndex);
+	}
+
+	return true;
+}
+/***
+ * Position code stream at first tile part, so that any tile
+ * can be found again after previous decompressions
+ */
+bool CodeStreamDecompress::rewindToFirstTilePart(void)
+{
+	uint64_t firstTilePart = codeStreamInfo->getMainHeaderEnd() + MARKER_BYTES;
+	if(stream_->tell() != firstTilePart && !stream_->seek(firstTilePart))
+	{
+		GRK_ERROR("Unable to seek to first tile part");
+		return false;
+	}
+	curr_marker_ = J2K_MS_SOT;
+	decompressorState_.setState(DECOMPRESS_STATE_TPH_SOT);
+	decompressorState_.lastSotReadPosition = 0;
+	if(cp_.tlm_markers)
+		cp_.tlm_markers->rewind();
 
 	return true;
 }
@@ -51,6 +51,7 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	bool setDecompressRegion(grk_rect_single region);
 	bool decompress(grk_plugin_tile* tile);
 	bool decompressTile(uint16_t tileIndex);
+	void getTileCacheStats(grk_tile_cache_stats* stats);
 	bool preProcess(void);
 	bool postProcess(void);
 	CodeStreamInfo* getCodeStreamInfo(void);
@@ -95,10 +96,13 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	bool readHeaderProcedureImpl(void);
 	bool decompressExec();
 	bool decompressTile();
+	bool rewindToFirstTilePart(void);
 	bool findNextSOT(TileProcessor* tileProcessor);
 	bool skipNonScheduledTLM(CodingParams* cp);
+	void prefetchTileParts(void);
 	bool hasTLM(void);
 	void nextTLM(void);
+	bool loadIndex(void);
 	bool decompressTiles(void);
 	bool decompressValidation(void);
 	bool copy_default_tcp(void);
@@ -326,6 +330,8 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	uint8_t* marker_scratch_;
 	uint16_t marker_scratch_size_;
 	GrkImage* outputImage_;
+	// decompress region in canvas coordinates, or empty for entire image
+	grk_rect32 decompressRegion_;
 	TileCache* tileCache_;
 	StripCache stripCache_;
 	grk_io_pixels_callback ioBufferCallback;
@@ -224,6 +224,10 @@ struct EncodingParams
 	bool writeTLM;
 	/* rate control algorithm */
 	uint32_t rateControlAlgorithm;
+	/* maximum number of tiles compressed but not yet written */
+	uint32_t maxTilesInFlight;
+	/* HT code block encoder */
+	GRK_HT_ENCODER htEncoder;
 };
 
 struct DecodingParams
@@ -236,6 +240,10 @@ struct DecodingParams
 	uint16_t layer_;
 
 	uint32_t randomAccessFlags_;
+	/** HTJ2K code block decoder */
+	GRK_HT_DECODER htDecoder_;
+	/** keep parsed code blocks of decompressed tiles in LRU tile cache */
+	bool tileCacheCodeBlocks_;
 };
 
 /**
@@ -281,6 +289,8 @@ struct CodingParams
 	} coding_params_;
 	TileLengthMarkers* tlm_markers;
 	PLMarkerMgr* plm_markers;
+	/** persistent code stream index (decompress only) */
+	CodeStreamIndex* codeStreamIndex_;
 	bool wholeTileDecompress_;
 };
 
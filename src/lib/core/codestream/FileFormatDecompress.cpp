@@ -319,6 +319,10 @@ bool FileFormatDecompress::decompressTile(uint16_t tileIndex)
 
 	return true;
 }
+void FileFormatDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	codeStream->getTileCacheStats(stats);
+}
 uint32_t FileFormatDecompress::read_asoc(AsocBox* parent, uint8_t** header_data,
 										 uint32_t* header_data_size, uint32_t asocSize)
 {
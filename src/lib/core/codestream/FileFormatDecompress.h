@@ -37,6 +37,7 @@ class FileFormatDecompress : public FileFormat, public ICodeStreamDecompress
 	bool setDecompressRegion(grk_rect_single region);
 	bool decompress(grk_plugin_tile* tile);
 	bool decompressTile(uint16_t tileIndex);
+	void getTileCacheStats(grk_tile_cache_stats* stats);
 	bool end(void);
 	bool postProcess(void);
 	bool preProcess(void);
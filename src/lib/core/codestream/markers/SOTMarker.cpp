@@ -213,6 +213,12 @@ bool SOTMarker::read(CodeStreamDecompress* codeStream, uint8_t* headerData, uint
 
 	codeStream->currentProcessor()->setTilePartDataLength(
 		currentTilePart, tilePartLength, decompressState->lastTilePartInCodeStream);
+	if(cp->codeStreamIndex_ && tilePartLength >= sot_marker_segment_min_len)
+	{
+		auto sotPosition =
+			codeStream->getStream()->tell() - header_size - MARKER_PLUS_MARKER_LENGTH_BYTES;
+		cp->codeStreamIndex_->pushTilePart(sotPosition, tileIndex, tilePartLength);
+	}
 	decompressState->setState(DECOMPRESS_STATE_TPH);
 
 	grk_pt16 currTile(tileIndex % cp->t_grid_width, tileIndex / cp->t_grid_width);
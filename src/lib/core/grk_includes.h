@@ -89,12 +89,14 @@
 #include "CodeStreamLimits.h"
 #include "geometry.h"
 #include "MemManager.h"
+#include "BlockArena.h"
 #include "buffer.h"
 #include "minpf_plugin_manager.h"
 #include "plugin_interface.h"
 #include "ICacheable.h"
 #include "TileSet.h"
 #include "GrkObjectWrapper.h"
+#include "ExecutorPool.h"
 #include "logger.h"
 #include "ChronoTimer.h"
 #include "testing.h"
@@ -109,6 +111,7 @@
 #include "BufferedStream.h"
 #include "Profile.h"
 #include "LengthCache.h"
+#include "CodeStreamIndex.h"
 #include "PLMarkerMgr.h"
 #include "PLCache.h"
 #include "SIZMarker.h"
@@ -152,6 +155,7 @@
 #include "plugin_bridge.h"
 #include "RateControl.h"
 #include "RateInfo.h"
+#include "HTRateControl.h"
 #include "T1Factory.h"
 #include "DecompressScheduler.h"
 #include "CompressScheduler.h"
@@ -45,16 +45,27 @@ struct GrkCodec
 		return &obj;
 	}
 
+	void setExecutor(grk_executor* executor)
+	{
+		grk_object_unref(executor_);
+		executor_ = grk_object_ref(executor);
+	}
+	tf::Executor* getExecutor(void)
+	{
+		return executor_ ? ExecutorPool::getImpl(executor_)->getExecutor() : nullptr;
+	}
+
 	grk_object obj;
 	ICodeStreamCompress* compressor_;
 	ICodeStreamDecompress* decompressor_;
 
   private:
 	grk_stream* stream_;
+	grk_executor* executor_;
 };
 
 GrkCodec::GrkCodec(grk_stream* stream)
-	: compressor_(nullptr), decompressor_(nullptr), stream_(stream)
+	: compressor_(nullptr), decompressor_(nullptr), stream_(stream), executor_(nullptr)
 {
 	obj.wrapper = new GrkObjectWrapperImpl<GrkCodec>(this);
 }
@@ -64,6 +75,7 @@ GrkCodec::~GrkCodec()
 	delete compressor_;
 	delete decompressor_;
 	grk_object_unref(stream_);
+	grk_object_unref(executor_);
 }
 
 /**
@@ -125,6 +137,15 @@ GRK_API void GRK_CALLCONV grk_deinitialize()
 {
 	grk_plugin_cleanup();
 	ExecSingleton::release();
+	BlockArena::releaseFreeChunks();
+	T1Factory::releaseFreeCompressors();
+}
+
+GRK_API grk_executor* GRK_CALLCONV grk_executor_create(uint32_t numthreads, uint64_t affinity_mask)
+{
+	auto pool = new ExecutorPool(numthreads, affinity_mask);
+
+	return pool->getWrapper();
 }
 
 GRK_API grk_object* GRK_CALLCONV grk_object_ref(grk_object* obj)
@@ -305,6 +326,46 @@ static grk_codec* grk_decompress_create_from_file(const char* file_name)
 
 	return codec;
 }
+static grk_codec* grk_decompress_create_from_callbacks(grk_stream_params* stream_params)
+{
+	if(!stream_params->seek_fn)
+	{
+		GRK_ERROR("Callback stream requires a seek function.");
+		return nullptr;
+	}
+	uint8_t buf[12];
+	size_t bytesRead = stream_params->read_fn(buf, 12, stream_params->user_data);
+	if(bytesRead != 12 || !stream_params->seek_fn(0, stream_params->user_data))
+	{
+		GRK_ERROR("Unable to read from callback stream.");
+		return nullptr;
+	}
+	GRK_CODEC_FORMAT fmt;
+	if(!grk_decompress_buffer_detect_format(buf, 12, &fmt))
+	{
+		GRK_ERROR("Unable to detect codec format.");
+		return nullptr;
+	}
+	auto stream = grk_stream_new(1024 * 1024, true);
+	auto bstream = BufferedStream::getImpl(stream);
+	bstream->setFormat(fmt);
+	grk_stream_set_user_data(stream, stream_params->user_data, stream_params->free_user_data_fn);
+	grk_stream_set_user_data_length(stream, stream_params->stream_len);
+	grk_stream_set_read_function(stream, stream_params->read_fn);
+	grk_stream_set_seek_function(stream, stream_params->seek_fn);
+	bstream->setPrefetchFunction(stream_params->prefetch_fn);
+	auto codec = grk_decompress_create(stream);
+	if(!codec)
+	{
+		GRK_ERROR("Unable to create codec for callback stream.");
+		// user data belongs to caller until codec is created
+		grk_stream_set_user_data(stream, nullptr, nullptr);
+		grk_object_unref(stream);
+		return nullptr;
+	}
+
+	return codec;
+}
 void GRK_CALLCONV grk_decompress_set_default_params(grk_decompress_parameters* parameters)
 {
 	if(!parameters)
@@ -326,6 +387,8 @@ grk_codec* GRK_CALLCONV grk_decompress_init(grk_stream_params* stream_params,
 		codecWrapper = grk_decompress_create_from_file(stream_params->file);
 	else if(stream_params->buf)
 		codecWrapper = grk_decompress_create_from_buffer(stream_params->buf, stream_params->len);
+	else if(stream_params->read_fn)
+		codecWrapper = grk_decompress_create_from_callbacks(stream_params);
 	if(!codecWrapper)
 		return nullptr;
 
@@ -337,6 +400,7 @@ grk_codec* GRK_CALLCONV grk_decompress_init(grk_stream_params* stream_params,
 		return nullptr;
 	}
 
+	codec->setExecutor(core_params->executor);
 	codec->decompressor_->init(core_params);
 
 	return codecWrapper;
@@ -348,6 +412,7 @@ bool GRK_CALLCONV grk_decompress_read_header(grk_codec* codecWrapper, grk_header
 		auto codec = GrkCodec::getImpl(codecWrapper);
 		if(!codec->decompressor_)
 			return false;
+		ExecutorScope scope(codec->getExecutor());
 		bool rc = codec->decompressor_->readHeader(header_info);
 		rc &= codec->decompressor_->preProcess();
 
@@ -372,6 +437,7 @@ bool GRK_CALLCONV grk_decompress(grk_codec* codecWrapper, grk_plugin_tile* tile)
 	if(codecWrapper)
 	{
 		auto codec = GrkCodec::getImpl(codecWrapper);
+		ExecutorScope scope(codec->getExecutor());
 		bool rc = codec->decompressor_ ? codec->decompressor_->decompress(tile) : false;
 		rc = rc && (codec->decompressor_ ? codec->decompressor_->postProcess() : false);
 
@@ -384,6 +450,7 @@ bool GRK_CALLCONV grk_decompress_tile(grk_codec* codecWrapper, uint16_t tileInde
 	if(codecWrapper)
 	{
 		auto codec = GrkCodec::getImpl(codecWrapper);
+		ExecutorScope scope(codec->getExecutor());
 		bool rc = codec->decompressor_ ? codec->decompressor_->decompressTile(tileIndex) : false;
 		rc = rc && (codec->decompressor_ ? codec->decompressor_->postProcess() : false);
 		return rc;
@@ -439,6 +506,20 @@ grk_image* GRK_CALLCONV grk_decompress_get_tile_image(grk_codec* codecWrapper, u
 	}
 	return nullptr;
 }
+bool GRK_CALLCONV grk_decompress_get_tile_cache_stats(grk_codec* codecWrapper,
+													  grk_tile_cache_stats* stats)
+{
+	if(codecWrapper && stats)
+	{
+		auto codec = GrkCodec::getImpl(codecWrapper);
+		if(!codec->decompressor_)
+			return false;
+		codec->decompressor_->getTileCacheStats(stats);
+
+		return true;
+	}
+	return false;
+}
 
 grk_image* GRK_CALLCONV grk_decompress_get_composited_image(grk_codec* codecWrapper)
 {
@@ -539,6 +620,7 @@ grk_codec* GRK_CALLCONV grk_compress_init(grk_stream_params* stream_params,
 	}
 
 	auto codec = GrkCodec::getImpl(codecWrapper);
+	codec->setExecutor(parameters->executor);
 	bool rc = codec->compressor_ ? codec->compressor_->init(parameters, (GrkImage*)p_image) : false;
 	if(rc)
 	{
@@ -558,6 +640,7 @@ static bool grk_compress_start(grk_codec* codecWrapper)
 	if(codecWrapper)
 	{
 		auto codec = GrkCodec::getImpl(codecWrapper);
+		ExecutorScope scope(codec->getExecutor());
 		return codec->compressor_ ? codec->compressor_->start() : false;
 	}
 	return false;
@@ -568,6 +651,7 @@ uint64_t GRK_CALLCONV grk_compress(grk_codec* codecWrapper, grk_plugin_tile* til
 	if(codecWrapper)
 	{
 		auto codec = GrkCodec::getImpl(codecWrapper);
+		ExecutorScope scope(codec->getExecutor());
 		return codec->compressor_ ? codec->compressor_->compress(tile) : 0;
 	}
 	return 0;
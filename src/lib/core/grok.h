@@ -127,6 +127,9 @@ typedef struct _grk_object
 	void* wrapper;
 } grk_object;
 
+/* opaque executor object : pool of worker threads that can be shared between codecs */
+typedef grk_object grk_executor;
+
 /**
  * Progression order change
  *
@@ -455,8 +458,38 @@ typedef void (*grk_io_register_reclaim_callback)(grk_io_init io_init,
 												 void* io_user_data, void* reclaim_user_data);
 typedef bool (*grk_io_pixels_callback)(uint32_t threadId, grk_io_buf buffer, void* user_data);
 
+/*
+ * read callback
+ *
+ */
+typedef size_t (*grk_stream_read_fn)(uint8_t* buffer, size_t numBytes, void* user_data);
+/*
+ * (absolute) seek callback
+ */
+typedef bool (*grk_stream_seek_fn)(uint64_t numBytes, void* user_data);
+/*
+ *  free user data callback
+ */
+typedef void (*grk_stream_free_user_data_fn)(void* user_data);
+
 /**
- * JPEG 2000 stream parameters - either file or buffer
+ * Byte range of stream
+ */
+typedef struct _grk_stream_range
+{
+	uint64_t offset;
+	uint64_t length;
+} grk_stream_range;
+
+/*
+ * prefetch callback : notifies client of byte ranges that the decompressor
+ * is about to read, in stream order. Adjacent ranges are merged.
+ */
+typedef void (*grk_stream_prefetch_fn)(const grk_stream_range* ranges, size_t numRanges,
+									   void* user_data);
+
+/**
+ * JPEG 2000 stream parameters - either file, buffer or callbacks
  */
 typedef struct _grk_stream_params
 {
@@ -470,14 +503,66 @@ typedef struct _grk_stream_params
 	size_t len;
 	// length of compressed stream (set by compressor, not client)
 	size_t buf_compressed_len;
+
+	/* Callbacks (decompression only) */
+	// read and (absolute) seek callbacks
+	grk_stream_read_fn read_fn;
+	grk_stream_seek_fn seek_fn;
+	// optional prefetch callback, for sources with high latency such as object stores.
+	// Byte ranges are derived from TLM markers, or from the code stream index
+	grk_stream_prefetch_fn prefetch_fn;
+	// optional callback to free user data when codec is destroyed
+	grk_stream_free_user_data_fn free_user_data_fn;
+	void* user_data;
+	// total length of stream
+	uint64_t stream_len;
 } grk_stream_params;
 
 typedef enum _GRK_TILE_CACHE_STRATEGY
 {
 	GRK_TILE_CACHE_NONE, /* no tile caching */
-	GRK_TILE_CACHE_IMAGE /* cache final tile image */
+	GRK_TILE_CACHE_IMAGE, /* cache final tile image */
+	GRK_TILE_CACHE_LRU /* cache tiles up to a byte budget, evicting least recently used tiles */
 } GRK_TILE_CACHE_STRATEGY;
 
+/**
+ * Tile cache statistics
+ */
+typedef struct _grk_tile_cache_stats
+{
+	/* tile requests served from cache, including code block hits */
+	uint64_t hits;
+	/* tile requests served from cached code blocks, without T2 */
+	uint64_t codeBlockHits;
+	/* tile requests that required reading tile from code stream */
+	uint64_t misses;
+	/* tiles evicted to stay within byte budget */
+	uint64_t evictions;
+	/* approximate number of bytes currently cached */
+	uint64_t bytes;
+} grk_tile_cache_stats;
+
+/**
+ * HTJ2K code block decoder implementation
+ */
+typedef enum _GRK_HT_DECODER
+{
+	GRK_HT_DECODER_AUTO, /* fastest implementation supported by the CPU */
+	GRK_HT_DECODER_SCALAR, /* portable implementation */
+	GRK_HT_DECODER_SSSE3, /* x86 SSSE3 implementation */
+	GRK_HT_DECODER_AVX2 /* x86 AVX2 implementation */
+} GRK_HT_DECODER;
+
+/**
+ * HTJ2K code block encoder implementation
+ */
+typedef enum _GRK_HT_ENCODER
+{
+	GRK_HT_ENCODER_AUTO, /* fastest implementation supported by the CPU */
+	GRK_HT_ENCODER_SCALAR, /* portable implementation */
+	GRK_HT_ENCODER_AVX2 /* x86 AVX2 implementation */
+} GRK_HT_ENCODER;
+
 /**
  * Core decompression parameters
  * */
@@ -499,12 +584,30 @@ typedef struct _grk_decompress_core_params
 	 */
 	uint16_t max_layers;
 	GRK_TILE_CACHE_STRATEGY tileCacheStrategy;
+	/* byte budget for GRK_TILE_CACHE_LRU, or zero for no limit */
+	uint64_t tileCacheBytes;
+	/* for GRK_TILE_CACHE_LRU, also cache parsed code blocks, so that a tile can be
+	 * decompressed again at a different window with T1 and DWT only.
+	 * Each tile is then fully parsed by T2, regardless of decompress window */
+	bool tileCacheCodeBlocks;
 
 	uint32_t randomAccessFlags_;
 
 	grk_io_pixels_callback io_buffer_callback;
 	void* io_user_data;
 	grk_io_register_reclaim_callback io_register_client_callback;
+	/* executor to run on; if NULL, then the library's global executor is used */
+	grk_executor* executor;
+	/* HTJ2K code block decoder; other than GRK_HT_DECODER_AUTO, this is intended for testing.
+	 * If the requested implementation is not supported by the CPU, then the fastest supported
+	 * implementation is used instead */
+	GRK_HT_DECODER htDecoder;
+	/* path of persistent code stream index file, or NULL for no index.
+	 * Tile part and packet lengths collected while decompressing are stored in this file,
+	 * and are used in place of missing TLM and PLT markers when the same code stream
+	 * is decompressed again. An index that does not match the code stream is ignored
+	 * and rebuilt */
+	const char* index_file;
 } grk_decompress_core_params;
 
 #define GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT (UINT_MAX)
@@ -568,6 +671,13 @@ typedef struct _grk_decompress_params
 	uint32_t kernelBuildOptions;
 	uint32_t repeats;
 	uint32_t numThreads;
+	/* store code stream index in sidecar file <input file>.grkidx */
+	bool index_sidecar;
+	/* number of files decompressed concurrently, when decompressing a directory */
+	uint32_t batchSize;
+	/* memory budget in bytes for decompressed images of files in flight,
+	 * or zero for no limit */
+	uint64_t batchMemory;
 	void* user_data;
 } grk_decompress_parameters;
 
@@ -769,6 +879,21 @@ GRK_API void GRK_CALLCONV grk_initialize(const char* pluginPath, uint32_t numthr
  */
 GRK_API void GRK_CALLCONV grk_deinitialize();
 
+/**
+ * Create executor, with its own pool of worker threads.
+ * An executor is attached to a codec through grk_decompress_core_params::executor
+ * or grk_cparameters::executor, and may be shared by several codecs.
+ * The codec holds a reference to its executor, so caller may release
+ * its own reference with grk_object_unref once codec has been created.
+ *
+ * @param numthreads 	number of worker threads; if zero, then number of cores is used
+ * @param affinity_mask	if non-zero, bit i is set if workers may run on logical CPU i
+ *
+ * @return executor
+ */
+GRK_API grk_executor* GRK_CALLCONV grk_executor_create(uint32_t numthreads,
+													   uint64_t affinity_mask);
+
 /**
  * Increment ref count
  */
@@ -865,6 +990,17 @@ GRK_API bool GRK_CALLCONV grk_decompress_read_header(grk_codec* codec,
  */
 GRK_API grk_image* GRK_CALLCONV grk_decompress_get_tile_image(grk_codec* codec, uint16_t tileIndex);
 
+/**
+ * Get tile cache statistics
+ *
+ * @param	codec				decompression codec
+ * @param	stats				statistics
+ *
+ * @return true if successful
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_get_tile_cache_stats(grk_codec* codec,
+															  grk_tile_cache_stats* stats);
+
 /**
  * Get decompressed composite image
  *
@@ -1035,9 +1171,22 @@ typedef struct _grk_cparameters
 	uint32_t duration; /* seconds */
 	uint32_t kernelBuildOptions;
 	uint32_t repeats;
+	/* number of files compressed concurrently, when compressing a directory */
+	uint32_t batchSize;
 	bool writePLT;
 	bool writeTLM;
 	bool verbose;
+	/** maximum number of tiles that are compressed concurrently and held in memory
+	 *  before being written to the code stream. Tiles are written in order,
+	 *  as soon as all preceding tiles have been written.
+	 *  If equal to zero, twice the number of threads is used */
+	uint32_t maxTilesInFlight;
+	/* executor to run on; if NULL, then the library's global executor is used */
+	grk_executor* executor;
+	/* HTJ2K code block encoder; other than GRK_HT_ENCODER_AUTO, this is intended for testing.
+	 * If the requested implementation is not supported by the CPU, then the fastest supported
+	 * implementation is used instead */
+	GRK_HT_ENCODER htEncoder;
 } grk_cparameters;
 
 /**
@@ -0,0 +1,198 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *    This source code incorporates work covered by the BSD 2-clause license.
+ *    Please see the LICENSE file in the root directory for details.
+ *
+ */
+#include "grk_includes.h"
+#include "colour.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "point_transform/colour.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	static void sycc_to_rgb_scalar(const int32_t* y, const int32_t* cb, const int32_t* cr,
+								   int32_t* r, int32_t* g, int32_t* b, uint32_t begin,
+								   uint32_t end, int32_t offset, int32_t upb)
+	{
+		for(uint32_t i = begin; i < end; ++i)
+		{
+			int32_t vy = y[i];
+			int32_t vcb = cb[i] - offset;
+			int32_t vcr = cr[i] - offset;
+			r[i] = std::clamp<int32_t>(vy + (int32_t)(1.402 * vcr), 0, upb);
+			g[i] = std::clamp<int32_t>(vy - (int32_t)(0.344 * vcb + 0.714 * vcr), 0, upb);
+			b[i] = std::clamp<int32_t>(vy + (int32_t)(1.772 * vcb), 0, upb);
+		}
+	}
+	/**
+	 * sYCC to RGB, computed in double precision to match the scalar conversion
+	 */
+	void hwy_sycc_to_rgb(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r,
+						 int32_t* g, int32_t* b, uint32_t w, int32_t offset, int32_t upb)
+	{
+		uint32_t i = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const uint32_t N = (uint32_t)Lanes(dd);
+		const auto voffset = Set(di, offset);
+		const auto vzero = Zero(di);
+		const auto vupb = Set(di, upb);
+		const auto vr_cr = Set(dd, 1.402);
+		const auto vg_cb = Set(dd, 0.344);
+		const auto vg_cr = Set(dd, 0.714);
+		const auto vb_cb = Set(dd, 1.772);
+		for(; i + N <= w; i += N)
+		{
+			auto vy = LoadU(di, y + i);
+			auto vcb = PromoteTo(dd, Sub(LoadU(di, cb + i), voffset));
+			auto vcr = PromoteTo(dd, Sub(LoadU(di, cr + i), voffset));
+			auto vr = Add(vy, DemoteTo(di, Mul(vr_cr, vcr)));
+			auto vg = Sub(vy, DemoteTo(di, Add(Mul(vg_cb, vcb), Mul(vg_cr, vcr))));
+			auto vb = Add(vy, DemoteTo(di, Mul(vb_cb, vcb)));
+			StoreU(Min(Max(vr, vzero), vupb), di, r + i);
+			StoreU(Min(Max(vg, vzero), vupb), di, g + i);
+			StoreU(Min(Max(vb, vzero), vupb), di, b + i);
+		}
+#endif
+		sycc_to_rgb_scalar(y, cb, cr, r, g, b, i, w, offset, upb);
+	}
+
+	static void esycc_to_rgb_scalar(int32_t* y, int32_t* cb, int32_t* cr, uint32_t begin,
+									uint32_t end, int32_t flipCb, int32_t flipCr,
+									int32_t maxValue)
+	{
+		for(uint32_t i = begin; i < end; ++i)
+		{
+			int32_t vy = y[i];
+			int32_t vcb = cb[i] - flipCb;
+			int32_t vcr = cr[i] - flipCr;
+			y[i] = std::clamp<int32_t>((int32_t)(vy - 0.0000368 * vcb + 1.40199 * vcr + 0.5), 0,
+									   maxValue);
+			cb[i] = std::clamp<int32_t>(
+				(int32_t)(1.0003 * vy - 0.344125 * vcb - 0.7141128 * vcr + 0.5), 0, maxValue);
+			cr[i] = std::clamp<int32_t>(
+				(int32_t)(0.999823 * vy + 1.77204 * vcb - 0.000008 * vcr + 0.5), 0, maxValue);
+		}
+	}
+	void hwy_esycc_to_rgb(int32_t* y, int32_t* cb, int32_t* cr, uint32_t w, int32_t flipCb,
+						  int32_t flipCr, int32_t maxValue)
+	{
+		uint32_t i = 0;
+#if HWY_HAVE_FLOAT64
+		const HWY_FULL(double) dd;
+		const Rebind<int32_t, decltype(dd)> di;
+		const uint32_t N = (uint32_t)Lanes(dd);
+		const auto vflipCb = Set(di, flipCb);
+		const auto vflipCr = Set(di, flipCr);
+		const auto vzero = Zero(di);
+		const auto vmax = Set(di, maxValue);
+		const auto vhalf = Set(dd, 0.5);
+		for(; i + N <= w; i += N)
+		{
+			auto vy = PromoteTo(dd, LoadU(di, y + i));
+			auto vcb = PromoteTo(dd, Sub(LoadU(di, cb + i), vflipCb));
+			auto vcr = PromoteTo(dd, Sub(LoadU(di, cr + i), vflipCr));
+			auto vr = Add(Add(Sub(vy, Mul(Set(dd, 0.0000368), vcb)), Mul(Set(dd, 1.40199), vcr)),
+						  vhalf);
+			auto vg = Add(Sub(Sub(Mul(Set(dd, 1.0003), vy), Mul(Set(dd, 0.344125), vcb)),
+							  Mul(Set(dd, 0.7141128), vcr)),
+						  vhalf);
+			auto vb = Add(Sub(Add(Mul(Set(dd, 0.999823), vy), Mul(Set(dd, 1.77204), vcb)),
+							  Mul(Set(dd, 0.000008), vcr)),
+						  vhalf);
+			StoreU(Min(Max(DemoteTo(di, vr), vzero), vmax), di, y + i);
+			StoreU(Min(Max(DemoteTo(di, vg), vzero), vmax), di, cb + i);
+			StoreU(Min(Max(DemoteTo(di, vb), vzero), vmax), di, cr + i);
+		}
+#endif
+		esycc_to_rgb_scalar(y, cb, cr, i, w, flipCb, flipCr, maxValue);
+	}
+
+	void hwy_cmyk_to_rgb(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t w,
+						 const float* scale)
+	{
+		const HWY_FULL(float) df;
+		const RebindToSigned<decltype(df)> di;
+		const uint32_t N = (uint32_t)Lanes(df);
+		const auto vone = Set(df, 1.0F);
+		const auto v255 = Set(df, 255.0F);
+		const auto vsC = Set(df, scale[0]);
+		const auto vsM = Set(df, scale[1]);
+		const auto vsY = Set(df, scale[2]);
+		const auto vsK = Set(df, scale[3]);
+		uint32_t i = 0;
+		for(; i + N <= w; i += N)
+		{
+			/* inverted CMYK values from 0 to 1 */
+			auto vC = Sub(vone, Mul(ConvertTo(df, LoadU(di, c + i)), vsC));
+			auto vM = Sub(vone, Mul(ConvertTo(df, LoadU(di, m + i)), vsM));
+			auto vY = Sub(vone, Mul(ConvertTo(df, LoadU(di, y + i)), vsY));
+			auto vK = Sub(vone, Mul(ConvertTo(df, LoadU(di, k + i)), vsK));
+			/* CMYK -> RGB : RGB results from 0 to 255 */
+			StoreU(ConvertTo(di, Mul(Mul(v255, vC), vK)), di, c + i);
+			StoreU(ConvertTo(di, Mul(Mul(v255, vM), vK)), di, m + i);
+			StoreU(ConvertTo(di, Mul(Mul(v255, vY), vK)), di, y + i);
+		}
+		for(; i < w; ++i)
+		{
+			float C = 1.0F - (float)c[i] * scale[0];
+			float M = 1.0F - (float)m[i] * scale[1];
+			float Y = 1.0F - (float)y[i] * scale[2];
+			float K = 1.0F - (float)k[i] * scale[3];
+			c[i] = (int32_t)(255.0F * C * K);
+			m[i] = (int32_t)(255.0F * M * K);
+			y[i] = (int32_t)(255.0F * Y * K);
+		}
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_sycc_to_rgb);
+HWY_EXPORT(hwy_esycc_to_rgb);
+HWY_EXPORT(hwy_cmyk_to_rgb);
+
+void colour::sycc_to_rgb(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r,
+						 int32_t* g, int32_t* b, uint32_t w, int32_t offset, int32_t upb)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_sycc_to_rgb)(y, cb, cr, r, g, b, w, offset, upb);
+}
+void colour::esycc_to_rgb(int32_t* y, int32_t* cb, int32_t* cr, uint32_t w, int32_t flipCb,
+						  int32_t flipCr, int32_t maxValue)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_esycc_to_rgb)(y, cb, cr, w, flipCb, flipCr, maxValue);
+}
+void colour::cmyk_to_rgb(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t w,
+						 const float* scale)
+{
+	HWY_DYNAMIC_DISPATCH(hwy_cmyk_to_rgb)(c, m, y, k, w, scale);
+}
+
+} // namespace grk
+#endif
@@ -0,0 +1,74 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *    This source code incorporates work covered by the BSD 2-clause license.
+ *    Please see the LICENSE file in the root directory for details.
+ *
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace grk
+{
+/**
+ * Row kernels for colour space conversion to RGB, vectorized with
+ * runtime dispatch to the best available SIMD target
+ */
+class colour
+{
+  public:
+	/**
+	 Convert one row of sYCC to RGB. Chroma must be at full resolution.
+	 Output rows may alias the input rows.
+	 @param y			luma row
+	 @param cb			blue chroma row
+	 @param cr			red chroma row
+	 @param r			red output row
+	 @param g			green output row
+	 @param b			blue output row
+	 @param w			row width
+	 @param offset		chroma offset, 2^(prec - 1)
+	 @param upb			maximum output value
+	 */
+	static void sycc_to_rgb(const int32_t* y, const int32_t* cb, const int32_t* cr, int32_t* r,
+							int32_t* g, int32_t* b, uint32_t w, int32_t offset, int32_t upb);
+	/**
+	 Convert one row of eSYCC to RGB, in place
+	 @param y			luma row, replaced by red
+	 @param cb			blue chroma row, replaced by green
+	 @param cr			red chroma row, replaced by blue
+	 @param w			row width
+	 @param flipCb		offset subtracted from unsigned blue chroma, or zero
+	 @param flipCr		offset subtracted from unsigned red chroma, or zero
+	 @param maxValue	maximum output value
+	 */
+	static void esycc_to_rgb(int32_t* y, int32_t* cb, int32_t* cr, uint32_t w, int32_t flipCb,
+							 int32_t flipCr, int32_t maxValue);
+	/**
+	 Convert one row of CMYK to 8 bit RGB, in place
+	 @param c			cyan row, replaced by red
+	 @param m			magenta row, replaced by green
+	 @param y			yellow row, replaced by blue
+	 @param k			black row
+	 @param w			row width
+	 @param scale		reciprocal of maximum C,M,Y and K values
+	 */
+	static void cmyk_to_rgb(int32_t* c, int32_t* m, int32_t* y, const int32_t* k, uint32_t w,
+							const float* scale);
+};
+
+} // namespace grk
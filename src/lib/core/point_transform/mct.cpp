@@ -32,7 +32,7 @@ namespace HWY_NAMESPACE
 	using namespace hwy::HWY_NAMESPACE;
 	/**
 	 * Apply dc shift for irreversible decompressed image.
-	 * (assumes mono with no  MCT)
+	 * (single component with no MCT)
 	 * input is floating point, output is 32 bit integer
 	 */
 	class DecompressDcShiftIrrev
@@ -59,13 +59,13 @@ namespace HWY_NAMESPACE
 			}
 			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
 				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
-											  info.yEnd);
+											  info.yEnd, 1);
 		}
 	};
 
 	/**
 	 * Apply dc shift for reversible decompressed image
-	 * (assumes mono with no MCT)
+	 * (single component with no MCT)
 	 * input and output buffers are both 32 bit integer
 	 */
 	class DecompressDcShiftRev
@@ -92,7 +92,7 @@ namespace HWY_NAMESPACE
 			}
 			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
 				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
-											  info.yEnd);
+											  info.yEnd, 1);
 		}
 	};
 
@@ -140,6 +140,9 @@ namespace HWY_NAMESPACE
 				Store(Clamp(g + vdcg, ming, maxg), di, chan1 + j);
 				Store(Clamp(b + vdcb, minb, maxb), di, chan2 + j);
 			}
+			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
+				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
+											  info.yEnd, 3);
 		}
 	};
 
@@ -199,6 +202,9 @@ namespace HWY_NAMESPACE
 				Store(Clamp(NearestInt(vg) + vdcg, ming, maxg), di, c1 + j);
 				Store(Clamp(NearestInt(vb) + vdcb, minb, maxb), di, c2 + j);
 			}
+			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
+				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
+											  info.yEnd, 3);
 		}
 	};
 
@@ -332,7 +338,7 @@ namespace HWY_NAMESPACE
 			}
 			if(tasks)
 			{
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] tasks;
 			}
 		}
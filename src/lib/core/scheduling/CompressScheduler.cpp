@@ -20,9 +20,12 @@
 namespace grk
 {
 CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
-									 const double* mct_norms, uint16_t mct_numcomps)
+									 const double* mct_norms, uint16_t mct_numcomps,
+									 GRK_HT_ENCODER htEncoder)
 	: Scheduler(tile), tile(tile), needsRateControl(needsRateControl), encodeBlocks(nullptr),
-	  blockCount(-1), tcp_(tcp), mct_norms_(mct_norms), mct_numcomps_(mct_numcomps)
+	  blockCount(-1), tcp_(tcp), mct_norms_(mct_norms), mct_numcomps_(mct_numcomps),
+	  htEncoder_(htEncoder), htRateControl_(needsRateControl && tcp->isHT()),
+	  t1Key_{tcp->isHT(), 0, 0, htEncoder}
 {
 	for(uint16_t compno = 0; compno < numcomps_; ++compno)
 	{
@@ -30,6 +33,41 @@ CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodi
 		imageComponentFlows_[compno] = new ImageComponentFlow(numResolutions);
 	}
 }
+CompressScheduler::~CompressScheduler()
+{
+	for(auto block : htBlocks_)
+		BlockArena::destroy(block);
+	for(auto band : htBands_)
+		delete band;
+	for(auto t1 : t1Implementations)
+		T1Factory::releaseCompressor(t1, t1Key_);
+	t1Implementations.clear();
+}
+std::vector<HTBandStats*>& CompressScheduler::getHTBands(void)
+{
+	return htBands_;
+}
+void CompressScheduler::recompressHT(void)
+{
+	for(auto band : htBands_)
+	{
+		if(band->droppedPlanes != band->codedPlanes)
+		{
+			band->codedBytes = 0;
+			band->codedPlanes = band->droppedPlanes;
+		}
+	}
+	std::vector<CompressBlockExec*> blocks;
+	for(auto block : htBlocks_)
+	{
+		if(block->droppedPlanes != block->htBand->droppedPlanes)
+		{
+			block->droppedPlanes = block->htBand->droppedPlanes;
+			blocks.push_back(block);
+		}
+	}
+	compress(&blocks);
+}
 bool CompressScheduler::schedule(uint16_t compno)
 {
 	return scheduleBlocks(compno);
@@ -52,6 +90,20 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 			for(bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
 			{
 				auto band = &res->tileBand[bandIndex];
+				HTBandStats* htBand = nullptr;
+				if(htRateControl_)
+				{
+					double w1 = (mct_norms_ && compno < mct_numcomps_) ? mct_norms_[compno] : 1.0;
+					double w2 = T1::getnorm((uint32_t)(tilec->numresolutions - 1 - resno),
+											(uint8_t)band->orientation, tccp->qmfbid == 1);
+					// reversible coefficients are integers, whatever the signalled step size
+					double stepsize = tccp->qmfbid == 1 ? 1.0 : band->stepsize;
+					double weight = w1 * w2 * stepsize;
+					htBand = new HTBandStats(weight * weight,
+											 (uint8_t)(band->numbps ? band->numbps - 1 : 0),
+											 tccp->qmfbid == 1);
+					htBands_.push_back(htBand);
+				}
 				for(auto prc : band->precincts)
 				{
 					auto nominalBlockSize = prc->getNominalBlockSize();
@@ -62,7 +114,7 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 							continue;
 						if(!cblk->allocData(nominalBlockSize))
 							continue;
-						auto block = new CompressBlockExec();
+						auto block = blockArena_.make<CompressBlockExec>();
 						block->tile = tile;
 						block->doRateControl = needsRateControl;
 						block->x = cblk->x0;
@@ -85,14 +137,18 @@ bool CompressScheduler::scheduleBlocks(uint16_t compno)
 						block->mct_norms = mct_norms_;
 						block->mct_numcomps = mct_numcomps_;
 						block->k_msbs = (uint8_t)(band->numbps - cblk->numbps);
+						block->htBand = htBand;
 						blocks.push_back(block);
 					}
 				}
 			}
 		}
 	}
+	t1Key_ = {tcp_->isHT(), maxCblkW, maxCblkH, htEncoder_};
 	for(auto i = 0U; i < ExecSingleton::get()->num_workers(); ++i)
-		t1Implementations.push_back(T1Factory::makeT1(true, tcp_, maxCblkW, maxCblkH));
+		t1Implementations.push_back(T1Factory::acquireCompressor(tcp_, t1Key_));
+	if(htRateControl_)
+		htBlocks_ = blocks;
 	compress(&blocks);
 
 	return true;
@@ -110,10 +166,12 @@ void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 		for(auto iter = blocks->begin(); iter != blocks->end(); ++iter)
 		{
 			compress(impl, *iter);
-			delete *iter;
+			if(!htRateControl_)
+				BlockArena::destroy(*iter);
 		}
 		return;
 	}
+	blockCount = -1;
 	const size_t maxBlocks = blocks->size();
 	encodeBlocks = new CompressBlockExec*[maxBlocks];
 	for(uint64_t i = 0; i < maxBlocks; ++i)
@@ -133,7 +191,7 @@ void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 			{}
 		});
 	}
-	ExecSingleton::get()->run(taskflow).wait();
+	ExecSingleton::run(taskflow);
 
 	delete[] node;
 	delete[] encodeBlocks;
@@ -146,7 +204,8 @@ bool CompressScheduler::compress(size_t threadId, uint64_t maxBlocks)
 		return false;
 	auto block = encodeBlocks[index];
 	compress(impl, block);
-	delete block;
+	if(!htRateControl_)
+		BlockArena::destroy(block);
 
 	return true;
 }
@@ -22,9 +22,19 @@ class CompressScheduler : public Scheduler
 {
   public:
 	CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
-					  const double* mct_norms, uint16_t mct_numcomps);
-	~CompressScheduler() = default;
+					  const double* mct_norms, uint16_t mct_numcomps, GRK_HT_ENCODER htEncoder);
+	~CompressScheduler();
 	bool schedule(uint16_t compno) override;
+	/**
+	 * Get HT rate control statistics for each band of the tile
+	 * (empty unless HT code blocks are compressed with rate control)
+	 */
+	std::vector<HTBandStats*>& getHTBands(void);
+	/**
+	 * Compress again all HT code blocks whose band's number of dropped
+	 * bit planes has changed since they were last compressed
+	 */
+	void recompressHT(void);
 
   private:
 	bool scheduleBlocks(uint16_t compno);
@@ -40,6 +50,13 @@ class CompressScheduler : public Scheduler
 	TileCodingParams* tcp_;
 	const double* mct_norms_;
 	uint16_t mct_numcomps_;
+	GRK_HT_ENCODER htEncoder_;
+	// HT rate control: blocks are kept after compressing, for recompressHT
+	bool htRateControl_;
+	std::vector<HTBandStats*> htBands_;
+	std::vector<CompressBlockExec*> htBlocks_;
+	// key of T1 compressors, which are returned to the factory's free list
+	T1CompressorKey t1Key_;
 };
 
 } // namespace grk
@@ -31,7 +31,7 @@ bool ResDecompressBlocks::empty(void) const
 void ResDecompressBlocks::release(void)
 {
 	for(auto& b : blocks_)
-		delete b;
+		BlockArena::destroy(b);
 	blocks_.clear();
 }
 
@@ -94,6 +94,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 	auto tccp = tcp_->tccps + compno;
 	auto tilec = tile_->comps + compno;
 	bool wholeTileDecoding = tilec->isWholeTileDecoding();
+	bool keepCompressedData = tileProcessor_->cp_->coding_params_.dec_.tileCacheCodeBlocks_;
 	uint8_t resno = 0;
 	for(; resno <= tilec->highestResolutionDecompressed; ++resno)
 	{
@@ -113,7 +114,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 					if(wholeTileDecoding || paddedBandWindow->nonEmptyIntersection(&cblkBounds))
 					{
 						auto cblk = precinct->getDecompressedBlockPtr(cblkno);
-						auto block = new DecompressBlockExec();
+						auto block = blockArena_.make<DecompressBlockExec>();
 						block->x = cblk->x0;
 						block->y = cblk->y0;
 						block->tilec = tilec;
@@ -125,6 +126,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 						block->qmfbid = tccp->qmfbid;
 						block->resno = resno;
 						block->roishift = tccp->roishift;
+						block->keepCompressedData = keepCompressedData;
 						block->stepsize = band->stepsize;
 						block->k_msbs = (uint8_t)(band->numbps - cblk->numbps);
 						block->R_b = prec_ + gain_b[band->orientation];
@@ -159,9 +161,10 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 	// nominal code block dimensions
 	uint16_t codeblock_width = (uint16_t)(tccp->cblkw ? (uint32_t)1 << tccp->cblkw : 0);
 	uint16_t codeblock_height = (uint16_t)(tccp->cblkh ? (uint32_t)1 << tccp->cblkh : 0);
+	auto htDecoder = tileProcessor_->cp_->coding_params_.dec_.htDecoder_;
 	for(auto i = 0U; i < ExecSingleton::get()->num_workers(); ++i)
 		t1Implementations.push_back(
-			T1Factory::makeT1(false, tcp_, codeblock_width, codeblock_height));
+			T1Factory::makeT1(false, tcp_, codeblock_width, codeblock_height, htDecoder));
 
 	size_t num_threads = ExecSingleton::get()->num_workers();
 	success = true;
@@ -173,7 +176,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 			{
 				if(!success)
 				{
-					delete block;
+					BlockArena::destroy(block);
 				}
 				else
 				{
@@ -195,7 +198,7 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 			resFlow->blocks_->nextTask().work([this, block] {
 				if(!success)
 				{
-					delete block;
+					BlockArena::destroy(block);
 				}
 				else
 				{
@@ -219,12 +222,12 @@ bool DecompressScheduler::decompressBlock(T1Interface* impl, DecompressBlockExec
 	try
 	{
 		bool rc = block->open(impl);
-		delete block;
+		BlockArena::destroy(block);
 		return rc;
 	}
 	catch(std::runtime_error& rerr)
 	{
-		delete block;
+		BlockArena::destroy(block);
 		GRK_ERROR(rerr.what());
 		return false;
 	}
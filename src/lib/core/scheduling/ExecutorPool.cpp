@@ -0,0 +1,85 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "grk_includes.h"
+
+namespace grk
+{
+ExecutorPool::WorkerHook::WorkerHook(std::shared_future<tf::Executor*> executor,
+									 uint64_t affinityMask)
+	: executor_(executor), affinityMask_(affinityMask)
+{}
+void ExecutorPool::WorkerHook::scheduler_prologue([[maybe_unused]] tf::Worker& worker)
+{
+	if(affinityMask_)
+	{
+#ifdef _WIN32
+		SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)affinityMask_);
+#elif defined(__linux__)
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for(uint32_t i = 0; i < 64; ++i)
+		{
+			if(affinityMask_ & ((uint64_t)1 << i))
+				CPU_SET(i, &cpus);
+		}
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+	}
+	// workers are spawned by the executor's constructor, so wait until
+	// the executor is published before attaching it to this thread
+	ExecSingleton::setCurrent(executor_.get());
+}
+void ExecutorPool::WorkerHook::scheduler_epilogue([[maybe_unused]] tf::Worker& worker,
+												  [[maybe_unused]] std::exception_ptr ptr)
+{
+	ExecSingleton::setCurrent(nullptr);
+}
+ExecutorPool::ExecutorPool(uint32_t numThreads, uint64_t affinityMask)
+{
+	obj.wrapper = new GrkObjectWrapperImpl<ExecutorPool>(this);
+	if(!numThreads)
+		numThreads = std::thread::hardware_concurrency();
+	std::promise<tf::Executor*> published;
+	auto hook = std::make_shared<WorkerHook>(published.get_future().share(), affinityMask);
+	executor_ = std::make_unique<tf::Executor>(numThreads, hook);
+	published.set_value(executor_.get());
+}
+ExecutorPool::~ExecutorPool()
+{
+	executor_->shutdown();
+}
+grk_object* ExecutorPool::getWrapper(void)
+{
+	return &obj;
+}
+ExecutorPool* ExecutorPool::getImpl(grk_object* executor)
+{
+	return ((GrkObjectWrapperImpl<ExecutorPool>*)executor->wrapper)->getWrappee();
+}
+tf::Executor* ExecutorPool::getExecutor(void)
+{
+	return executor_.get();
+}
+
+} // namespace grk
@@ -0,0 +1,61 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <future>
+#include <memory>
+
+namespace grk
+{
+/**
+ * Pool of worker threads that can be attached to a codec in place of the
+ * global executor, so that concurrent workloads can be given separate
+ * thread budgets
+ */
+class ExecutorPool
+{
+  public:
+	/**
+	 * Create pool
+	 *
+	 * @param numThreads number of worker threads; if zero, then number of cores is used
+	 * @param affinityMask bit i set if workers may run on logical CPU i;
+	 * if zero, then workers may run on any CPU
+	 */
+	ExecutorPool(uint32_t numThreads, uint64_t affinityMask);
+	~ExecutorPool();
+	grk_object* getWrapper(void);
+	static ExecutorPool* getImpl(grk_object* executor);
+	tf::Executor* getExecutor(void);
+
+  private:
+	class WorkerHook : public tf::WorkerInterface
+	{
+	  public:
+		WorkerHook(std::shared_future<tf::Executor*> executor, uint64_t affinityMask);
+		void scheduler_prologue(tf::Worker& worker) override;
+		void scheduler_epilogue(tf::Worker& worker, std::exception_ptr ptr) override;
+
+	  private:
+		std::shared_future<tf::Executor*> executor_;
+		uint64_t affinityMask_;
+	};
+	grk_object obj;
+	std::unique_ptr<tf::Executor> executor_;
+};
+
+} // namespace grk
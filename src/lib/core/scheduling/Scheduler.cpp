@@ -36,7 +36,7 @@ Scheduler::~Scheduler()
 }
 bool Scheduler::run(void)
 {
-	ExecSingleton::get()->run(codecFlow_).wait();
+	ExecSingleton::run(codecFlow_);
 
 	return success;
 }
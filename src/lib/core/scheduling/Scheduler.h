@@ -39,6 +39,8 @@ class Scheduler
 	Tile* tile_;
 	uint16_t numcomps_;
 	FlowComponent* prePostProc_;
+	// block executors for this tile
+	BlockArena blockArena_;
 };
 
 } // namespace grk
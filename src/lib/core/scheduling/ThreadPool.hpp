@@ -39,16 +39,114 @@ class ExecSingleton
 
 		return &singleton;
 	}
+	/**
+	 * Executor for the calling thread: the executor attached to the current codec
+	 * operation, or to the pool that owns this worker thread, otherwise the
+	 * global executor
+	 */
 	static tf::Executor* get()
 	{
-		return instance(0);
+		return current_ ? current_ : instance(0);
+	}
+	/**
+	 * Attach executor to calling thread, in place of the global executor
+	 *
+	 * @param exec executor, or nullptr to revert to the global executor
+	 * @return previously attached executor
+	 */
+	static tf::Executor* setCurrent(tf::Executor* exec)
+	{
+		auto prev = current_;
+		current_ = exec;
+		return prev;
 	}
 	static void release()
 	{
-		get()->shutdown();
+		instance(0)->shutdown();
+	}
+	/**
+	 * Run a task flow on the global executor and wait for it to complete.
+	 * When called from one of the executor's workers (nested parallelism, e.g.
+	 * a tile task scheduling its code blocks), the calling worker keeps
+	 * executing pending tasks while it waits, rather than blocking.
+	 */
+	static void run(tf::Taskflow& flow)
+	{
+		auto exec = get();
+		if(exec->this_worker_id() >= 0)
+			exec->run_and_wait(flow);
+		else
+			exec->run(flow).wait();
+	}
+	/**
+	 * Wait until predicate is satisfied. Workers keep executing pending
+	 * tasks while they wait; other threads wait on the condition variable
+	 */
+	template<typename P>
+	static void wait_until(std::mutex& mutex, std::condition_variable& cv, P&& predicate)
+	{
+		auto exec = get();
+		if(exec->this_worker_id() >= 0)
+		{
+			exec->loop_until([&mutex, &predicate] {
+				std::unique_lock<std::mutex> lk(mutex);
+				return predicate();
+			});
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lk(mutex);
+			cv.wait(lk, predicate);
+		}
+	}
+	/**
+	 * Split rows [0, height) into strips of stripHeight rows, and call
+	 * f(yBegin, yEnd) for each strip, in parallel if there is more than one worker
+	 */
+	template<typename F>
+	static void for_each_strip(uint32_t height, uint32_t stripHeight, F&& f)
+	{
+		if(!height)
+			return;
+		if(get()->num_workers() == 1 || height <= stripHeight)
+		{
+			f(0U, height);
+			return;
+		}
+		tf::Taskflow taskflow;
+		for(uint32_t y = 0; y < height; y += stripHeight)
+		{
+			uint32_t yEnd = std::min<uint32_t>(y + stripHeight, height);
+			taskflow.emplace([&f, y, yEnd] { f(y, yEnd); });
+		}
+		run(taskflow);
 	}
 	static uint32_t threadId(void)
 	{
 		return get()->num_workers() > 1 ? (uint32_t)ExecSingleton::get()->this_worker_id() : 0;
 	}
+
+  private:
+	static inline thread_local tf::Executor* current_ = nullptr;
+};
+
+/**
+ * Attaches an executor to the calling thread for the lifetime of the scope.
+ * A null executor leaves the current one in place
+ */
+class ExecutorScope
+{
+  public:
+	explicit ExecutorScope(tf::Executor* exec)
+		: prev_(exec ? ExecSingleton::setCurrent(exec) : nullptr), active_(exec != nullptr)
+	{}
+	~ExecutorScope()
+	{
+		if(active_)
+			ExecSingleton::setCurrent(prev_);
+	}
+
+  private:
+	tf::Executor* prev_;
+	bool active_;
 };
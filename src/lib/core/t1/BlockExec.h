@@ -19,6 +19,7 @@
 
 namespace grk
 {
+struct HTBandStats;
 struct BlockExec
 {
 	BlockExec()
@@ -43,7 +44,7 @@ struct BlockExec
 };
 struct DecompressBlockExec : public BlockExec
 {
-	DecompressBlockExec() : cblk(nullptr), resno(0), roishift(0) {}
+	DecompressBlockExec() : cblk(nullptr), resno(0), roishift(0), keepCompressedData(false) {}
 	bool open(T1Interface* t1)
 	{
 		return t1->decompress(this);
@@ -52,6 +53,8 @@ struct DecompressBlockExec : public BlockExec
 	DecompressCodeblock* cblk;
 	uint8_t resno;
 	uint8_t roishift;
+	// keep compressed data after decompression, so that block can be decompressed again
+	bool keepCompressedData;
 };
 struct CompressBlockExec : public BlockExec
 {
@@ -61,7 +64,7 @@ struct CompressBlockExec : public BlockExec
 #ifdef DEBUG_LOSSLESS_T1
 		  unencodedData(nullptr),
 #endif
-		  mct_numcomps(0)
+		  mct_numcomps(0), htBand(nullptr), droppedPlanes(0), maxBitLength(-1)
 	{}
 	bool open(T1Interface* t1)
 	{
@@ -83,6 +86,12 @@ struct CompressBlockExec : public BlockExec
 	int32_t* unencodedData;
 #endif
 	uint16_t mct_numcomps;
+	// HT rate control: statistics of block's band, or nullptr if rate control is disabled
+	HTBandStats* htBand;
+	// HT rate control: number of least significant bit planes dropped
+	uint8_t droppedPlanes;
+	// HT rate control: bit length of largest quantized magnitude, or -1 if not yet known
+	int8_t maxBitLength;
 };
 
 } // namespace grk
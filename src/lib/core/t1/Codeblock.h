@@ -200,11 +200,11 @@ struct CompressCodeblock : public Codeblock
 struct DecompressCodeblock : public Codeblock
 {
 	DecompressCodeblock(uint16_t numLayers)
-		: Codeblock(numLayers), segs(nullptr), numSegments(0),
+		: Codeblock(numLayers), segs(&inlineSegment_), numSegments(0),
 #ifdef DEBUG_LOSSLESS_T2
 		  included(0),
 #endif
-		  numSegmentsAllocated(0)
+		  numSegmentsAllocated(1)
 	{}
 	virtual ~DecompressCodeblock()
 	{
@@ -212,19 +212,15 @@ struct DecompressCodeblock : public Codeblock
 	}
 	Segment* getSegment(uint32_t segmentIndex)
 	{
-		if(!segs)
+		if(segmentIndex >= numSegmentsAllocated)
 		{
-			numSegmentsAllocated = 1;
-			segs = new Segment[numSegmentsAllocated];
-			numSegmentsAllocated = 1;
-		}
-		else if(segmentIndex >= numSegmentsAllocated)
-		{
-			auto new_segs = new Segment[2 * numSegmentsAllocated];
+			uint32_t newNumSegments = std::max<uint32_t>(2 * numSegmentsAllocated, segmentIndex + 1);
+			auto new_segs = new Segment[newNumSegments];
 			for(uint32_t i = 0; i < numSegmentsAllocated; ++i)
 				new_segs[i] = segs[i];
-			numSegmentsAllocated *= 2;
-			delete[] segs;
+			numSegmentsAllocated = newNumSegments;
+			if(segs != &inlineSegment_)
+				delete[] segs;
 			segs = new_segs;
 		}
 
@@ -249,15 +245,34 @@ struct DecompressCodeblock : public Codeblock
 	}
 	void cleanUpSegBuffers()
 	{
-		for(auto& b : seg_buffers)
-			delete b;
 		seg_buffers.clear();
 		numSegments = 0;
 	}
 	size_t getSegBuffersLen()
 	{
 		return std::accumulate(seg_buffers.begin(), seg_buffers.end(), (size_t)0,
-							   [](const size_t s, grk_buf8* a) { return (s + a->len); });
+							   [](const size_t s, const grk_buf8& a) { return (s + a.len); });
+	}
+	/**
+	 * Get compressed data, if it is stored contiguously in the code stream,
+	 * so that it can be decoded in place rather than copied
+	 *
+	 * @return pointer to compressed data, or nullptr if there is no data,
+	 * or data is split across non-adjacent buffers
+	 */
+	uint8_t* getContiguousSegBuffer(void)
+	{
+		if(seg_buffers.empty())
+			return nullptr;
+		auto begin = seg_buffers.front().buf;
+		auto end = begin + seg_buffers.front().len;
+		for(size_t i = 1; i < seg_buffers.size(); ++i)
+		{
+			if(seg_buffers[i].buf != end)
+				return nullptr;
+			end += seg_buffers[i].len;
+		}
+		return begin;
 	}
 	bool copyToContiguousBuffer(uint8_t* buffer)
 	{
@@ -266,24 +281,38 @@ struct DecompressCodeblock : public Codeblock
 		size_t offset = 0;
 		for(auto& buf : seg_buffers)
 		{
-			if(buf->len)
+			if(buf.len)
 			{
-				memcpy(buffer + offset, buf->buf, buf->len);
-				offset += buf->len;
+				memcpy(buffer + offset, buf.buf, buf.len);
+				offset += buf.len;
 			}
 		}
 		return true;
 	}
+	/**
+	 * Release decompressed samples, but keep compressed data
+	 * so that block can be decompressed again
+	 */
+	void releaseUncompressedData(void)
+	{
+		grk_buf2d::dealloc();
+	}
 	void release(void)
 	{
 		cleanUpSegBuffers();
-		delete[] segs;
-		segs = nullptr;
+		if(segs != &inlineSegment_)
+			delete[] segs;
+		segs = &inlineSegment_;
+		numSegmentsAllocated = 1;
+		inlineSegment_.clear();
 		grk_buf2d::dealloc();
 	}
-	std::vector<grk_buf8*> seg_buffers;
+	// non-owning views onto packet data, one per packet contribution
+	std::vector<grk_buf8> seg_buffers;
 
   private:
+	// most code blocks have a single segment, which is stored inline
+	Segment inlineSegment_;
 	Segment* segs; /* information on segments */
 	uint32_t numSegments; /* number of segment in block*/
 	uint32_t numSegmentsAllocated; // number of segments allocated for segs array
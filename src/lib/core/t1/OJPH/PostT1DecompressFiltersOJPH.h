@@ -9,8 +9,10 @@ class RoiShiftOJPHFilter
 {
   public:
 	RoiShiftOJPHFilter(grk::DecompressBlockExec* block)
-		: roiShift(block->roishift), shift(31U - (block->k_msbs + 1U))
-	{}
+		: roiShift(block->roishift), shift(31U - block->bandNumbps)
+	{
+		assert(block->bandNumbps <= 31);
+	}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
 		T thresh = 1 << roiShift;
@@ -33,7 +35,13 @@ template<typename T>
 class ShiftOJPHFilter
 {
   public:
-	ShiftOJPHFilter(grk::DecompressBlockExec* block) : shift(31U - (block->k_msbs + 1U)) {}
+	// as with scaling, the band's most significant bit plane is at bit 30 of the
+	// decoded sample, so least significant bit planes that were not coded are
+	// reconstructed at the mid-point of their interval
+	ShiftOJPHFilter(grk::DecompressBlockExec* block) : shift(31U - block->bandNumbps)
+	{
+		assert(block->bandNumbps <= 31);
+	}
 	inline void copy(T* dest, T* src, uint32_t len)
 	{
 		for(uint32_t i = 0; i < len; ++i)
@@ -22,25 +22,117 @@
 #include "T1OJPH.h"
 
 #include "grk_includes.h"
+#ifndef OJPH_DISABLE_INTEL_SIMD
+#include "hwy/targets.h"
+#endif
 
-const uint8_t grk_cblk_dec_compressed_data_pad_ht = 8;
+// the SIMD decoders may read up to 16 bytes past the end of their input
+const uint8_t grk_cblk_dec_compressed_data_pad_ht = 16;
 
 namespace ojph
 {
+/**
+ * Decoded code block stride: the SIMD decoders write whole
+ * 8 sample rows of quads
+ */
+static uint32_t decodedStride(uint32_t width)
+{
+	return (width + 7) & ~7U;
+}
+/**
+ * Select the HT code block decoder
+ *
+ * @param requested requested decoder
+ * @return fastest supported decoder if requested decoder is GRK_HT_DECODER_AUTO
+ * or is not supported by the CPU, otherwise requested decoder
+ */
+static GRK_HT_DECODER selectDecoder(GRK_HT_DECODER requested)
+{
+	auto best = GRK_HT_DECODER_SCALAR;
+#ifndef OJPH_DISABLE_INTEL_SIMD
+	auto targets = hwy::SupportedTargets();
+	if(targets & HWY_AVX2)
+		best = GRK_HT_DECODER_AVX2;
+	else if(targets & HWY_SSSE3)
+		best = GRK_HT_DECODER_SSSE3;
+#endif
+	if(requested == GRK_HT_DECODER_AUTO)
+		return best;
+	if(requested > best)
+	{
+		static std::atomic<bool> warned(false);
+		if(!warned.exchange(true))
+			grk::GRK_WARN("Requested HT code block decoder %u is not supported: using decoder %u",
+						  (uint32_t)requested, (uint32_t)best);
+		return best;
+	}
+
+	return requested;
+}
+/**
+ * Select the HT code block encoder
+ *
+ * @param requested requested encoder
+ * @return fastest supported encoder if requested encoder is GRK_HT_ENCODER_AUTO
+ * or is not supported by the CPU, otherwise requested encoder
+ */
+static GRK_HT_ENCODER selectEncoder(GRK_HT_ENCODER requested)
+{
+	auto best = GRK_HT_ENCODER_SCALAR;
+#ifndef OJPH_DISABLE_INTEL_SIMD
+	if(hwy::SupportedTargets() & HWY_AVX2)
+		best = GRK_HT_ENCODER_AVX2;
+#endif
+	if(requested == GRK_HT_ENCODER_AUTO)
+		return best;
+	if(requested > best)
+	{
+		static std::atomic<bool> warned(false);
+		if(!warned.exchange(true))
+			grk::GRK_WARN("Requested HT code block encoder %u is not supported: using encoder %u",
+						  (uint32_t)requested, (uint32_t)best);
+		return best;
+	}
+
+	return requested;
+}
 T1OJPH::T1OJPH(bool isCompressor, [[maybe_unused]] grk::TileCodingParams* tcp, uint32_t maxCblkW,
-			   uint32_t maxCblkH)
+			   uint32_t maxCblkH, GRK_HT_DECODER htDecoder, GRK_HT_ENCODER htEncoder)
 	: coded_data_size(isCompressor ? 0 : (uint32_t)(maxCblkW * maxCblkH * sizeof(int32_t))),
 	  coded_data(isCompressor ? nullptr : new uint8_t[coded_data_size]),
-	  unencoded_data_size(maxCblkW * maxCblkH), unencoded_data(new int32_t[unencoded_data_size]),
-	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576))
+	  unencoded_data_size(decodedStride(maxCblkW) * ((maxCblkH + 3) & ~3U)),
+	  unencoded_data((int32_t*)grk::grk_aligned_malloc(unencoded_data_size * sizeof(int32_t))),
+	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576)),
+	  decode_codeblock(local::ojph_decode_codeblock), decode_in_place(true), encode_avx2(false)
 {
-	if(!isCompressor)
+	if(isCompressor)
+	{
+		encode_avx2 = selectEncoder(htEncoder) == GRK_HT_ENCODER_AVX2;
+	}
+	else
+	{
 		memset(coded_data, 0, grk_cblk_dec_compressed_data_pad_ht);
+		switch(selectDecoder(htDecoder))
+		{
+#ifndef OJPH_DISABLE_INTEL_SIMD
+			case GRK_HT_DECODER_AVX2:
+				decode_codeblock = local::ojph_decode_codeblock_avx2;
+				decode_in_place = false;
+				break;
+			case GRK_HT_DECODER_SSSE3:
+				decode_codeblock = local::ojph_decode_codeblock_ssse3;
+				decode_in_place = false;
+				break;
+#endif
+			default:
+				break;
+		}
+	}
 }
 T1OJPH::~T1OJPH()
 {
 	delete[] coded_data;
-	delete[] unencoded_data;
+	grk::grk_aligned_free(unencoded_data);
 	delete allocator;
 	delete elastic_alloc;
 }
@@ -92,10 +184,38 @@ void T1OJPH::preCompress([[maybe_unused]] grk::CompressBlockExec* block,
 		}
 	}
 }
+void T1OJPH::analyse(grk::CompressBlockExec* block)
+{
+	auto cblk = block->cblk;
+	uint32_t w = cblk->width();
+	uint32_t h = cblk->height();
+	uint32_t tile_width =
+		(block->tile->comps + block->compno)->getWindow()->getResWindowBufferHighestStride();
+	uint32_t count[32] = {};
+	double sumSquares[32] = {};
+	uint32_t maxMagnitude = 0;
+	for(uint32_t j = 0; j < h; ++j)
+	{
+		auto tiledp = block->tiledp + (uint64_t)j * tile_width;
+		for(uint32_t i = 0; i < w; ++i)
+		{
+			uint32_t mu;
+			if(block->qmfbid == 1)
+				mu = (uint32_t)std::abs(tiledp[i]);
+			else
+				mu = (uint32_t)std::abs(((float*)tiledp)[i] * block->inv_step_ht);
+			uint32_t bitLength = mu ? 32U - count_leading_zeros(mu) : 0;
+			count[bitLength]++;
+			sumSquares[bitLength] += (double)mu * (double)mu;
+			maxMagnitude |= mu;
+		}
+	}
+	block->maxBitLength =
+		(int8_t)(maxMagnitude ? 32U - count_leading_zeros(maxMagnitude) : 0);
+	block->htBand->add(count, sumSquares);
+}
 bool T1OJPH::compress(grk::CompressBlockExec* block)
 {
-	preCompress(block, block->tile);
-
 	coded_lists* next_coded = nullptr;
 	auto cblk = block->cblk;
 	cblk->numbps = 0;
@@ -104,16 +224,46 @@ bool T1OJPH::compress(grk::CompressBlockExec* block)
 	uint16_t w = (uint16_t)cblk->width();
 	uint16_t h = (uint16_t)cblk->height();
 
+	if(block->htBand && block->maxBitLength < 0)
+		analyse(block);
+	// all quantized magnitudes lie in the dropped bit planes: nothing to code
+	if(block->droppedPlanes && block->maxBitLength <= (int8_t)block->droppedPlanes)
+	{
+		cblk->numPassesTotal = 0;
+		return true;
+	}
+	// dropped bit planes are signalled as missing most significant bit planes
+	uint32_t missing_msbs = (uint32_t)(block->k_msbs - block->droppedPlanes);
+
 	uint32_t pass_length[2] = {0, 0};
-	ojph::local::ojph_encode_codeblock((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w,
-									   pass_length, elastic_alloc, next_coded);
+#ifndef OJPH_DISABLE_INTEL_SIMD
+	if(encode_avx2)
+	{
+		// quantization is fused into the encoder, which reads the tile buffer directly
+		uint32_t tile_width = (block->tile->comps + block->compno)
+								  ->getWindow()
+								  ->getResWindowBufferHighestStride();
+		ojph::local::ojph_encode_codeblock_avx2(block->tiledp, block->qmfbid == 1,
+												block->inv_step_ht, block->k_msbs,
+												block->droppedPlanes, 1, w, h, tile_width,
+												pass_length, elastic_alloc, next_coded);
+	}
+	else
+#endif
+	{
+		preCompress(block, block->tile);
+		ojph::local::ojph_encode_codeblock((uint32_t*)unencoded_data, missing_msbs, 1, w, h, w,
+										   pass_length, elastic_alloc, next_coded);
+	}
 
 	cblk->numPassesTotal = 1;
 	cblk->passes[0].len = (uint16_t)pass_length[0];
 	cblk->passes[0].rate = (uint16_t)pass_length[0];
-	cblk->numbps = 1;
+	cblk->numbps = (uint8_t)(1 + block->droppedPlanes);
 	assert(cblk->paddedCompressedStream);
 	memcpy(cblk->paddedCompressedStream, next_coded->buf, (size_t)pass_length[0]);
+	if(block->htBand)
+		block->htBand->codedBytes += pass_length[0];
 
 	return true;
 }
@@ -122,25 +272,29 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 	auto cblk = block->cblk;
 	if(!cblk->area())
 		return true;
-	uint16_t stride = (uint16_t)cblk->width();
+	uint16_t stride = (uint16_t)decodedStride(cblk->width());
 	if(!cblk->seg_buffers.empty())
 	{
-		size_t total_seg_len = 2 * grk_cblk_dec_compressed_data_pad_ht + cblk->getSegBuffersLen();
-		if(coded_data_size < total_seg_len)
-		{
-			delete[] coded_data;
-			coded_data = new uint8_t[total_seg_len];
-			coded_data_size = (uint32_t)total_seg_len;
-			memset(coded_data, 0, grk_cblk_dec_compressed_data_pad_ht);
-		}
-		memset(coded_data + grk_cblk_dec_compressed_data_pad_ht + cblk->getSegBuffersLen(), 0,
-			   grk_cblk_dec_compressed_data_pad_ht);
-		uint8_t* actual_coded_data = coded_data + grk_cblk_dec_compressed_data_pad_ht;
-		size_t offset = 0;
-		for(auto& b : cblk->seg_buffers)
+		size_t offset = cblk->getSegBuffersLen();
+		// The scalar HT block decoder never reads outside of the lengths it is given,
+		// so when the code block's data is contiguous in the code stream
+		// (e.g. single layer, or consecutive packets), we decode it in place.
+		// Otherwise, segments are gathered into a zero-padded scratch buffer
+		uint8_t* actual_coded_data = decode_in_place ? cblk->getContiguousSegBuffer() : nullptr;
+		if(!actual_coded_data)
 		{
-			memcpy(actual_coded_data + offset, b->buf, b->len);
-			offset += b->len;
+			size_t total_seg_len = 2 * grk_cblk_dec_compressed_data_pad_ht + offset;
+			if(coded_data_size < total_seg_len)
+			{
+				delete[] coded_data;
+				coded_data = new uint8_t[total_seg_len];
+				coded_data_size = (uint32_t)total_seg_len;
+				memset(coded_data, 0, grk_cblk_dec_compressed_data_pad_ht);
+			}
+			memset(coded_data + grk_cblk_dec_compressed_data_pad_ht + offset, 0,
+				   grk_cblk_dec_compressed_data_pad_ht);
+			actual_coded_data = coded_data + grk_cblk_dec_compressed_data_pad_ht;
+			cblk->copyToContiguousBuffer(actual_coded_data);
 		}
 
 		size_t num_passes = 0;
@@ -153,9 +307,9 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 		bool rc = false;
 		if(num_passes && offset)
 		{
-			rc = ojph::local::ojph_decode_codeblock(
-				actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs, (uint32_t)num_passes,
-				(uint32_t)offset, 0, cblk->width(), cblk->height(), stride, false);
+			rc = decode_codeblock(actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs,
+								  (uint32_t)num_passes, (uint32_t)offset, 0, cblk->width(),
+								  cblk->height(), stride, false);
 		}
 		else
 		{
@@ -29,14 +29,24 @@ struct TileCodingParams;
 class T1OJPH : public grk::T1Interface
 {
   public:
-	T1OJPH(bool isCompressor, grk::TileCodingParams* tcp, uint32_t maxCblkW, uint32_t maxCblkH);
+	T1OJPH(bool isCompressor, grk::TileCodingParams* tcp, uint32_t maxCblkW, uint32_t maxCblkH,
+		   GRK_HT_DECODER htDecoder, GRK_HT_ENCODER htEncoder);
 	virtual ~T1OJPH();
 
+	typedef bool (*decode_fn)(uint8_t* coded_data, uint32_t* decoded_data, uint32_t missing_msbs,
+							  uint32_t num_passes, uint32_t lengths1, uint32_t lengths2,
+							  uint32_t width, uint32_t height, uint32_t stride,
+							  bool stripe_causal);
+
 	bool compress(grk::CompressBlockExec* block);
 	bool decompress(grk::DecompressBlockExec* block);
 
   private:
 	void preCompress(grk::CompressBlockExec* block, grk::Tile* tile);
+	/**
+	 * Gather statistics of block's quantized magnitudes for HT rate control
+	 */
+	void analyse(grk::CompressBlockExec* block);
 	bool postProcess(grk::DecompressBlockExec* block);
 
 	uint32_t coded_data_size;
@@ -46,5 +56,12 @@ class T1OJPH : public grk::T1Interface
 
 	mem_fixed_allocator* allocator;
 	mem_elastic_allocator* elastic_alloc;
+
+	// code block decoder selected at run time
+	decode_fn decode_codeblock;
+	// true if decoder never reads past the end of its input
+	bool decode_in_place;
+	// true if code blocks are quantized and encoded by the AVX2 encoder
+	bool encode_avx2;
 };
 } // namespace ojph
@@ -665,7 +665,7 @@ namespace ojph {
 
       // combine with earlier data
       assert(msp->bits >= 0 && msp->bits <= 128);
-      int cur_bytes = msp->bits >> 3;
+      int cur_bytes = (int)(msp->bits >> 3);
       int cur_bits = msp->bits & 7;
       __m128i b1, b2;
       b1 = _mm_sll_epi64(val, _mm_set1_epi64x(cur_bits));
@@ -677,7 +677,7 @@ namespace ojph {
       _mm_storeu_si128((__m128i*)(msp->tmp + cur_bytes), b2);
 
       int consumed_bits = bits < 128 - cur_bits ? bits : 128 - cur_bits;
-      cur_bytes = (msp->bits + (ui32)consumed_bits + 7) >> 3; // round up
+      cur_bytes = (int)((msp->bits + (ui32)consumed_bits + 7) >> 3); // round up
       int upper = _mm_extract_epi16(val, 7);
       upper >>= consumed_bits - 128 + 16;
       msp->tmp[cur_bytes] = (ui8)upper; // copy byte
@@ -1246,7 +1246,7 @@ namespace ojph {
           uvlc_entry >>= 3; 
           //extract suffixes for quad 0 and 1
           ui32 len = uvlc_entry & 0xF;           //suffix length for 2 quads
-          ui32 tmp = vlc_val & ((1 << len) - 1); //suffix value for 2 quads
+          ui32 tmp = vlc_val & ((1U << len) - 1); //suffix value for 2 quads
           vlc_val = rev_advance(&vlc, len);
           uvlc_entry >>= 4;
           // quad 0 length
@@ -1357,7 +1357,7 @@ namespace ojph {
             uvlc_entry >>= 3;
             //extract suffixes for quad 0 and 1
             ui32 len = uvlc_entry & 0xF;           //suffix length for 2 quads
-            ui32 tmp = vlc_val & ((1 << len) - 1); //suffix value for 2 quads
+            ui32 tmp = vlc_val & ((1U << len) - 1); //suffix value for 2 quads
             vlc_val = rev_advance(&vlc, len);
             uvlc_entry >>= 4;
             // quad 0 length
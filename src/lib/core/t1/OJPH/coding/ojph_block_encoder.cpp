@@ -62,14 +62,14 @@ namespace ojph {
     // index is (c_q << 8) + (rho << 4) + eps
     // data is  (cwd << 8) + (cwd_len << 4) + eps
     // table 0 is for the initial line of quads
-    static ui16 vlc_tbl0[2048] = { 0 };
-    static ui16 vlc_tbl1[2048] = { 0 };
+    ui16 vlc_enc_tbl0[2048] = { 0 };
+    ui16 vlc_enc_tbl1[2048] = { 0 };
 
     //UVLC encoding
-    static int ulvc_cwd_pre[33];
-    static int ulvc_cwd_pre_len[33];
-    static int ulvc_cwd_suf[33];
-    static int ulvc_cwd_suf_len[33];
+    int ulvc_cwd_pre[33];
+    int ulvc_cwd_pre_len[33];
+    int ulvc_cwd_suf[33];
+    int ulvc_cwd_suf_len[33];
 
     /////////////////////////////////////////////////////////////////////////
     static bool vlc_init_tables()
@@ -85,7 +85,7 @@ namespace ojph {
         pattern_popcnt[i] = (si32)population_count(i);
 
       vlc_src_table* src_tbl = tbl0;
-      ui16 *tgt_tbl = vlc_tbl0;
+      ui16 *tgt_tbl = vlc_enc_tbl0;
       size_t tbl_size = tbl0_size;
       for (int i = 0; i < 2048; ++i)
       {
@@ -139,7 +139,7 @@ namespace ojph {
       size_t tbl1_size = sizeof(tbl1) / sizeof(vlc_src_table);
 
       src_tbl = tbl1;
-      tgt_tbl = vlc_tbl1;
+      tgt_tbl = vlc_enc_tbl1;
       tbl_size = tbl1_size;
       for (int i = 0; i < 2048; ++i)
       {
@@ -587,7 +587,7 @@ namespace ojph {
         lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho[0] & 2) >> 1)); lcxp++;
         lcxp[0] = (ui8)((rho[0] & 8) >> 3);
 
-        ui16 tuple0 = vlc_tbl0[(c_q0 << 8) + (rho[0] << 4) + eps0];
+        ui16 tuple0 = vlc_enc_tbl0[(c_q0 << 8) + (rho[0] << 4) + eps0];
         vlc_encode(&vlc, tuple0 >> 8, (tuple0 >> 4) & 7);
 
         if (c_q0 == 0)
@@ -673,7 +673,7 @@ namespace ojph {
           lep[0] = (ui8)e_q[7];
           lcxp[0] |= (ui8)(lcxp[0] | (ui8)((rho[1] & 2) >> 1)); lcxp++;
           lcxp[0] = (ui8)((rho[1] & 8) >> 3);
-          ui16 tuple1 = vlc_tbl0[(c_q1 << 8) + (rho[1] << 4) + eps1];
+          ui16 tuple1 = vlc_enc_tbl0[(c_q1 << 8) + (rho[1] << 4) + eps1];
           vlc_encode(&vlc, tuple1 >> 8, (tuple1 >> 4) & 7);
 
           if (c_q1 == 0)
@@ -806,7 +806,7 @@ namespace ojph {
           lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho[0] & 2) >> 1)); lcxp++;
           int c_q1 = lcxp[0] + (lcxp[1] << 2);
           lcxp[0] = (ui8)((rho[0] & 8) >> 3);
-          ui16 tuple0 = vlc_tbl1[(c_q0 << 8) + (rho[0] << 4) + eps0];
+          ui16 tuple0 = vlc_enc_tbl1[(c_q0 << 8) + (rho[0] << 4) + eps0];
           vlc_encode(&vlc, tuple0 >> 8, (tuple0 >> 4) & 7);
 
           if (c_q0 == 0)
@@ -895,7 +895,7 @@ namespace ojph {
             lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho[1] & 2) >> 1)); lcxp++;
             c_q0 = lcxp[0] + (lcxp[1] << 2);
             lcxp[0] = (ui8)((rho[1] & 8) >> 3);
-            ui16 tuple1 = vlc_tbl1[(c_q1 << 8) + (rho[1] << 4) + eps1];
+            ui16 tuple1 = vlc_enc_tbl1[(c_q1 << 8) + (rho[1] << 4) + eps1];
             vlc_encode(&vlc, tuple1 >> 8, (tuple1 >> 4) & 7);
 
             if (c_q1 == 0)
@@ -51,12 +51,35 @@ namespace ojph {
   namespace local {
 
     //////////////////////////////////////////////////////////////////////////
+    // VLC and UVLC encoding tables, shared by the encoders
+    extern ui16 vlc_enc_tbl0[2048];
+    extern ui16 vlc_enc_tbl1[2048];
+    extern int ulvc_cwd_pre[33];
+    extern int ulvc_cwd_pre_len[33];
+    extern int ulvc_cwd_suf[33];
+    extern int ulvc_cwd_suf_len[33];
+
+    //////////////////////////////////////////////////////////////////////////
+    // generic encoder: buf holds sign-magnitude samples
     void
       ojph_encode_codeblock(ui32* buf, ui32 missing_msbs, ui32 num_passes,
                             ui32 width, ui32 height, ui32 stride,
                             ui32* lengths, 
                             ojph::mem_elastic_allocator *elastic,
                             ojph::coded_lists *& coded);
+
+    // AVX2-accelerated encoder, with fused quantization: buf holds
+    // wavelet coefficients, integers if reversible, otherwise floats
+    // that are quantized by inv_step; the dropped_planes least significant
+    // bit planes of the quantized magnitudes are not coded
+    void
+      ojph_encode_codeblock_avx2(const si32* buf, bool reversible,
+                                 float inv_step, ui32 missing_msbs,
+                                 ui32 dropped_planes, ui32 num_passes,
+                                 ui32 width, ui32 height, ui32 stride,
+                                 ui32* lengths,
+                                 ojph::mem_elastic_allocator *elastic,
+                                 ojph::coded_lists *& coded);
   }
 }
 
@@ -0,0 +1,707 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_avx2.cpp
+// Author: Aous Naman
+// Date: 17 September 2019
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_avx2.cpp
+ *  @brief implements AVX2-accelerated HTJ2K block encoder
+ *
+ *  The encoder works on one line of quads at a time, in two stages.
+ *  The first stage is vectorized: it quantizes the wavelet coefficients
+ *  of the two lines of samples, converts them to magnitude and sign, and
+ *  computes the exponent E_n of every sample, together with the
+ *  significance pattern rho, the maximum exponent and the candidate
+ *  EMB pattern of every quad.
+ *  The second stage emits the VLC, MEL and MagSgn bitstreams from these
+ *  values; it is serial, as each quad's context depends on its neighbours,
+ *  but it is branch-light, and bits are packed through 64-bit accumulators.
+ *  The output is identical to that of the generic encoder.
+ */
+
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <immintrin.h>
+#include "grok.h"
+#include "logger.h"
+
+#include "ojph_mem.h"
+#include "ojph_arch.h"
+#include "ojph_block_encoder.h"
+
+namespace ojph {
+  namespace local {
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    struct mel_struct {
+      //storage
+      ui8* buf;      //pointer to data buffer
+      ui32 pos;      //position of next writing within buf
+      ui32 buf_size; //size of buffer, which we must not exceed
+
+      // all these can be replaced by bytes
+      int remaining_bits; //number of empty bits in tmp
+      int tmp;            //temporary storage of coded bits
+      int run;            //number of 0 run
+      int k;              //state
+      int threshold;      //threshold where one bit must be coded
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    mel_init(mel_struct* melp, ui32 buffer_size, ui8* data)
+    {
+      melp->buf = data;
+      melp->pos = 0;
+      melp->buf_size = buffer_size;
+      melp->remaining_bits = 8;
+      melp->tmp = 0;
+      melp->run = 0;
+      melp->k = 0;
+      melp->threshold = 1; // this is 1 << mel_exp[melp->k];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    mel_emit_bit(mel_struct* melp, int v)
+    {
+      assert(v == 0 || v == 1);
+      melp->tmp = (melp->tmp << 1) + v;
+      melp->remaining_bits--;
+      if (melp->remaining_bits == 0)
+      {
+        if (melp->pos >= melp->buf_size)
+        {
+          grk::GRK_ERROR( "mel encoder's buffer is full");
+          return;
+        }
+
+        melp->buf[melp->pos++] = (ui8)melp->tmp;
+        melp->remaining_bits = (melp->tmp == 0xFF ? 7 : 8);
+        melp->tmp = 0;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    mel_encode(mel_struct* melp, bool bit)
+    {
+      //MEL exponent
+      static const int mel_exp[13] = {0,0,0,1,1,1,2,2,2,3,3,4,5};
+
+      if (bit == false)
+      {
+        ++melp->run;
+        if (melp->run >= melp->threshold)
+        {
+          mel_emit_bit(melp, 1);
+          melp->run = 0;
+          melp->k = ojph_min(12, melp->k + 1);
+          melp->threshold = 1 << mel_exp[melp->k];
+        }
+      }
+      else
+      {
+        mel_emit_bit(melp, 0);
+        int t = mel_exp[melp->k];
+        while (t > 0)
+          mel_emit_bit(melp, (melp->run >> --t) & 1);
+        melp->run = 0;
+        melp->k = ojph_max(0, melp->k - 1);
+        melp->threshold = 1 << mel_exp[melp->k];
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    struct vlc_struct {
+      //storage
+      ui8* buf;      //pointer to data buffer
+      ui32 pos;      //position of next writing within buf
+      ui32 buf_size; //size of buffer, which we must not exceed
+
+      int used_bits; //number of occupied bits in tmp
+      ui64 tmp;      //temporary storage of coded bits
+      bool last_greater_than_8F; //true if last byte us greater than 0x8F
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    vlc_init(vlc_struct* vlcp, ui32 buffer_size, ui8* data)
+    {
+      vlcp->buf = data + buffer_size - 1; //points to last byte
+      vlcp->pos = 1;                      //locations will be all -pos
+      vlcp->buf_size = buffer_size;
+
+      vlcp->buf[0] = 0xFF;
+      vlcp->used_bits = 4;
+      vlcp->tmp = 0xF;
+      vlcp->last_greater_than_8F = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // appends up to 32 bits, then writes all complete bytes; a byte that
+    // follows a byte greater than 0x8F holds 7 bits if these are all ones
+    static inline void
+    vlc_encode(vlc_struct* vlcp, ui32 cwd, int cwd_len)
+    {
+      vlcp->tmp |= (ui64)(cwd & (ui32)((1ULL << cwd_len) - 1))
+                   << vlcp->used_bits;
+      vlcp->used_bits += cwd_len;
+      while (vlcp->used_bits >= 7)
+      {
+        int bits = 8;
+        if (vlcp->last_greater_than_8F && (vlcp->tmp & 0x7F) == 0x7F)
+          bits = 7;
+        else if (vlcp->used_bits < 8)
+          break;
+        if (vlcp->pos >= vlcp->buf_size)
+        {
+          grk::GRK_ERROR( "vlc encoder's buffer is full");
+          return;
+        }
+        ui8 byte = (ui8)(vlcp->tmp & ((1U << bits) - 1));
+        *(vlcp->buf - vlcp->pos) = byte;
+        vlcp->pos++;
+        vlcp->last_greater_than_8F = byte > 0x8F;
+        vlcp->tmp >>= bits;
+        vlcp->used_bits -= bits;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    terminate_mel_vlc(mel_struct* melp, vlc_struct* vlcp)
+    {
+      if (melp->run > 0)
+        mel_emit_bit(melp, 1);
+
+      melp->tmp = melp->tmp << melp->remaining_bits;
+      int vlc_tmp = (int)vlcp->tmp;
+      int mel_mask = (0xFF << melp->remaining_bits) & 0xFF;
+      int vlc_mask = 0xFF >> (8 - vlcp->used_bits);
+      if ((mel_mask | vlc_mask) == 0)
+        return;  //last mel byte cannot be 0xFF, since then
+                 //melp->remaining_bits would be < 8
+      if (melp->pos >= melp->buf_size)
+      {
+        grk::GRK_ERROR( "mel encoder's buffer is full");
+        return;
+      }
+      int fuse = melp->tmp | vlc_tmp;
+      if ( ( ((fuse ^ melp->tmp) & mel_mask)
+           | ((fuse ^ vlc_tmp) & vlc_mask) ) == 0
+          && (fuse != 0xFF) && vlcp->pos > 1)
+      {
+        melp->buf[melp->pos++] = (ui8)fuse;
+      }
+      else
+      {
+        if (vlcp->pos >= vlcp->buf_size)
+        {
+          grk::GRK_ERROR( "vlc encoder's buffer is full");
+          return;
+        }
+        melp->buf[melp->pos++] = (ui8)melp->tmp; //melp->tmp cannot be 0xFF
+        *(vlcp->buf - vlcp->pos) = (ui8)vlc_tmp;
+        vlcp->pos++;
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    struct ms_struct {
+      //storage
+      ui8* buf;      //pointer to data buffer
+      ui32 pos;      //position of next writing within buf
+      ui32 buf_size; //size of buffer, which we must not exceed
+
+      int max_bits;  //maximum number of bits that can be store in next byte
+      int used_bits; //number of occupied bits in tmp
+      ui64 tmp;      //temporary storage of coded bits
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    ms_init(ms_struct* msp, ui32 buffer_size, ui8* data)
+    {
+      msp->buf = data;
+      msp->pos = 0;
+      msp->buf_size = buffer_size;
+      msp->max_bits = 8;
+      msp->used_bits = 0;
+      msp->tmp = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // writes all complete bytes; a byte that follows 0xFF holds 7 bits
+    static inline void
+    ms_flush(ms_struct* msp)
+    {
+      while (msp->used_bits >= msp->max_bits)
+      {
+        if (msp->pos >= msp->buf_size)
+        {
+          grk::GRK_ERROR( "magnitude sign encoder's buffer is full");
+          return;
+        }
+        ui8 byte = (ui8)(msp->tmp & ((1U << msp->max_bits) - 1));
+        msp->buf[msp->pos++] = byte;
+        msp->tmp >>= msp->max_bits;
+        msp->used_bits -= msp->max_bits;
+        msp->max_bits = (byte == 0xFF) ? 7 : 8;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // appends cwd_len < 32 bits; bytes are only written once 32 bits
+    // have accumulated
+    static inline void
+    ms_encode(ms_struct* msp, ui32 cwd, int cwd_len)
+    {
+      msp->tmp |= (ui64)cwd << msp->used_bits;
+      msp->used_bits += cwd_len;
+      if (msp->used_bits >= 32)
+        ms_flush(msp);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    ms_terminate(ms_struct* msp)
+    {
+      ms_flush(msp);
+      if (msp->used_bits)
+      {
+        int t = msp->max_bits - msp->used_bits; //unused bits
+        msp->tmp |= (0xFF & ((1U << t) - 1)) << msp->used_bits;
+        msp->used_bits += t;
+        if (msp->tmp != 0xFF)
+        {
+          if (msp->pos >= msp->buf_size)
+          {
+            grk::GRK_ERROR( "magnitude sign encoder's buffer is full");
+            return;
+          }
+          msp->buf[msp->pos++] = (ui8)msp->tmp;
+        }
+      }
+      else if (msp->max_bits == 7)
+        msp->pos--;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    // samples of one line of quads, in quad order, i.e., for quad q,
+    // entries 4q to 4q + 3 are samples (2q, y), (2q, y+1), (2q+1, y)
+    // and (2q+1, y+1)
+    struct quad_line {
+      ui32 s[2048];     //v_n = 2(\mu_p-1) + s_n, or 0 if insignificant
+      ui32 e[2048];     //E_n, or 0 if insignificant
+      ui32 e_max[2048]; //maximum E_n of the quad, for each of its samples
+      ui8 rho[512];     //significance pattern of each quad
+      ui8 eps[512];     //samples of each quad with E_n equal to the maximum
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    // loads the quantized magnitudes \mu_p of 8 samples, and their signs,
+    // exactly as the sign-magnitude conversion that precedes the generic
+    // encoder would produce them, with the drop least significant bit
+    // planes removed; lanes not in mask are zero
+    template <bool REVERSIBLE>
+    static inline __m256i
+    load_magnitude(const si32* sp, __m256i mask, ui32 p, ui32 drop,
+                   __m256 inv_step, __m256 scale, __m256i& sign)
+    {
+      __m256i t, mu;
+      if (REVERSIBLE)
+      {
+        // bits shifted above bit 30 are lost in the generic path
+        __m128i shift = _mm_cvtsi32_si128((int)p + 1);
+        t = _mm256_maskload_epi32(sp, mask);
+        mu = _mm256_srl_epi32(_mm256_sll_epi32(_mm256_abs_epi32(t), shift),
+                              shift);
+        mu = _mm256_srl_epi32(mu, _mm_cvtsi32_si128((int)drop));
+      }
+      else
+      {
+        __m256 f = _mm256_maskload_ps((const float*)sp, mask);
+        t = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(f, inv_step),
+                                              scale));
+        mu = _mm256_and_si256(_mm256_abs_epi32(t),
+                              _mm256_set1_epi32(INT_MAX));
+        mu = _mm256_srl_epi32(mu, _mm_cvtsi32_si128((int)(p + drop)));
+      }
+      sign = _mm256_srli_epi32(t, 31);
+      return mu;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // computes E_n and v_n from \mu_p and sign
+    static inline void
+    exponent_and_value(__m256i mu, __m256i sign, __m256i& e, __m256i& s)
+    {
+      const __m256i zero = _mm256_setzero_si256();
+      const __m256i one = _mm256_set1_epi32(1);
+      __m256i sig = _mm256_cmpgt_epi32(mu, zero);
+      __m256i w = _mm256_sub_epi32(mu, one); // \mu_p - 1
+      // the bit length of w is read from the exponent of its float
+      // representation; values above 24 bits are shifted down first,
+      // so that the conversion cannot round up to the next power of two
+      __m256i big = _mm256_cmpgt_epi32(w, _mm256_set1_epi32(0xFFFFFF));
+      __m256i wb = _mm256_blendv_epi8(w, _mm256_srli_epi32(w, 8), big);
+      __m256i len = _mm256_castps_si256(_mm256_cvtepi32_ps(wb));
+      len = _mm256_sub_epi32(_mm256_srli_epi32(len, 23),
+                             _mm256_set1_epi32(126));
+      len = _mm256_max_epi32(len, zero);
+      len = _mm256_add_epi32(len, _mm256_and_si256(big, _mm256_set1_epi32(8)));
+      // E_n is the bit length of 2\mu_p - 1, that is, of \mu_p - 1, plus one
+      e = _mm256_and_si256(_mm256_add_epi32(len, one), sig);
+      s = _mm256_and_si256(_mm256_add_epi32(_mm256_slli_epi32(w, 1), sign),
+                           sig);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // stores exponents of two quads, with their maximum exponent,
+    // significance and candidate EMB patterns
+    static inline void
+    store_quad_stats(quad_line* ql, ui32 q, __m256i e)
+    {
+      __m256i m = _mm256_max_epi32(e, _mm256_shuffle_epi32(e, 0xB1));
+      m = _mm256_max_epi32(m, _mm256_shuffle_epi32(m, 0x4E));
+      _mm256_storeu_si256((__m256i*)(ql->e + 4 * q), e);
+      _mm256_storeu_si256((__m256i*)(ql->e_max + 4 * q), m);
+      int rho = _mm256_movemask_ps(_mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(e, _mm256_setzero_si256())));
+      int eps = _mm256_movemask_ps(_mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(e, m)));
+      ql->rho[q] = (ui8)(rho & 0xF);
+      ql->rho[q + 1] = (ui8)(rho >> 4);
+      ql->eps[q] = (ui8)(eps & 0xF);
+      ql->eps[q + 1] = (ui8)(eps >> 4);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // quantizes and analyses two lines of samples; line1 is null if
+    // the code block has an odd number of lines and line0 is the last
+    template <bool REVERSIBLE>
+    static void
+    analyse_quad_line(const si32* line0, const si32* line1, ui32 width,
+                      ui32 p, ui32 drop, float inv_step, quad_line* ql)
+    {
+      const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      const __m256 inv = _mm256_set1_ps(inv_step);
+      const __m256 scale = _mm256_set1_ps((float)(1U << p));
+      for (ui32 x = 0; x < width; x += 8)
+      {
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(width - x)),
+                                          lane);
+        __m256i sign, e0, s0, e1, s1;
+        __m256i mu = load_magnitude<REVERSIBLE>(line0 + x, mask, p, drop, inv,
+                                                scale, sign);
+        exponent_and_value(mu, sign, e0, s0);
+        if (line1)
+        {
+          mu = load_magnitude<REVERSIBLE>(line1 + x, mask, p, drop, inv, scale,
+                                          sign);
+          exponent_and_value(mu, sign, e1, s1);
+        }
+        else
+          e1 = s1 = _mm256_setzero_si256();
+
+        // interleave the two lines into quad order: the low 128-bit lanes
+        // hold quads 0 and 1, the high lanes quads 2 and 3
+        __m256i lo = _mm256_unpacklo_epi32(s0, s1);
+        __m256i hi = _mm256_unpackhi_epi32(s0, s1);
+        _mm256_storeu_si256((__m256i*)(ql->s + 2 * x),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(ql->s + 2 * x + 8),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+        lo = _mm256_unpacklo_epi32(e0, e1);
+        hi = _mm256_unpackhi_epi32(e0, e1);
+        store_quad_stats(ql, x >> 1, _mm256_permute2x128_si256(lo, hi, 0x20));
+        store_quad_stats(ql, (x >> 1) + 2,
+                         _mm256_permute2x128_si256(lo, hi, 0x31));
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // emits the MagSgn bits of the significant samples of a quad
+    static inline void
+    ms_encode_quad(ms_struct* msp, const ui32* s, int rho, int Uq, int tuple)
+    {
+      for (int i = 0; i < 4; ++i)
+        if (rho & (1 << i))
+        {
+          int m = Uq - ((tuple >> i) & 1);
+          ms_encode(msp, s[i] & ((1U << m) - 1), m);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // emits the UVLC prefixes, then the suffixes, of two quads
+    static inline void
+    uvlc_encode(vlc_struct* vlcp, int u0, int u1)
+    {
+      ui32 cwd = (ui32)ulvc_cwd_pre[u0];
+      int len = ulvc_cwd_pre_len[u0];
+      cwd |= (ui32)ulvc_cwd_pre[u1] << len;
+      len += ulvc_cwd_pre_len[u1];
+      cwd |= (ui32)ulvc_cwd_suf[u0] << len;
+      len += ulvc_cwd_suf_len[u0];
+      cwd |= (ui32)ulvc_cwd_suf[u1] << len;
+      len += ulvc_cwd_suf_len[u1];
+      vlc_encode(vlcp, cwd, len);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+    template <bool REVERSIBLE>
+    static void
+    encode_codeblock(const si32* buf, float inv_step, ui32 missing_msbs,
+                     ui32 dropped_planes, ui32 width, ui32 height, ui32 stride,
+                     ui32* lengths,
+                     ojph::mem_elastic_allocator *elastic,
+                     ojph::coded_lists *& coded)
+    {
+      const int ms_size = (16384*16+14)/15;  //more than enough
+      ui8 ms_buf[ms_size];
+      const int mel_vlc_size = 3072;         //more than enough
+      ui8 mel_vlc_buf[mel_vlc_size];
+      const int mel_size = 192;
+      ui8 *mel_buf = mel_vlc_buf;
+      const int vlc_size = mel_vlc_size - mel_size;
+      ui8 *vlc_buf = mel_vlc_buf + mel_size;
+
+      mel_struct mel;
+      mel_init(&mel, mel_size, mel_buf);
+      vlc_struct vlc;
+      vlc_init(&vlc, vlc_size, vlc_buf);
+      ms_struct ms;
+      ms_init(&ms, ms_size, ms_buf);
+
+      ui32 p = 30 - missing_msbs;
+      quad_line ql;
+
+      //e_val and cx_val hold, for each pair of samples on the last line
+      // of the previous line of quads, the maximum of their E values and
+      // the OR of their significance; see the generic encoder
+      ui8 e_val[514];
+      ui8 cx_val[514];
+      ui8* lep = e_val;     lep[0] = 0;
+      ui8* lcxp = cx_val;   lcxp[0] = 0;
+
+      //initial line of quads
+      analyse_quad_line<REVERSIBLE>(buf, height > 1 ? buf + stride : nullptr,
+                                    width, p, dropped_planes, inv_step, &ql);
+      int c_q0 = 0;
+      for (ui32 x = 0, q = 0; x < width; x += 4, q += 2)
+      {
+        int rho0 = ql.rho[q], rho1 = 0;
+        int Uq0 = ojph_max((int)ql.e_max[4 * q], 1); //kappa_q = 1
+        int u_q0 = Uq0 - 1, u_q1 = 0; //kappa_q = 1
+        int eps0 = u_q0 > 0 ? ql.eps[q] : 0;
+
+        lep[0] = ojph_max(lep[0], (ui8)ql.e[4 * q + 1]); lep++;
+        lep[0] = (ui8)ql.e[4 * q + 3];
+        lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho0 & 2) >> 1)); lcxp++;
+        lcxp[0] = (ui8)((rho0 & 8) >> 3);
+
+        ui16 tuple0 = vlc_enc_tbl0[(c_q0 << 8) + (rho0 << 4) + eps0];
+        vlc_encode(&vlc, (ui32)(tuple0 >> 8), (tuple0 >> 4) & 7);
+        if (c_q0 == 0)
+          mel_encode(&mel, rho0 != 0);
+        ms_encode_quad(&ms, ql.s + 4 * q, rho0, Uq0, tuple0);
+
+        if (x + 2 < width)
+        {
+          rho1 = ql.rho[q + 1];
+          int c_q1 = (rho0 >> 1) | (rho0 & 1);
+          int Uq1 = ojph_max((int)ql.e_max[4 * q + 4], 1); //kappa_q = 1
+          u_q1 = Uq1 - 1; //kappa_q = 1
+          int eps1 = u_q1 > 0 ? ql.eps[q + 1] : 0;
+
+          lep[0] = ojph_max(lep[0], (ui8)ql.e[4 * q + 5]); lep++;
+          lep[0] = (ui8)ql.e[4 * q + 7];
+          lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho1 & 2) >> 1)); lcxp++;
+          lcxp[0] = (ui8)((rho1 & 8) >> 3);
+
+          ui16 tuple1 = vlc_enc_tbl0[(c_q1 << 8) + (rho1 << 4) + eps1];
+          vlc_encode(&vlc, (ui32)(tuple1 >> 8), (tuple1 >> 4) & 7);
+          if (c_q1 == 0)
+            mel_encode(&mel, rho1 != 0);
+          ms_encode_quad(&ms, ql.s + 4 * q + 4, rho1, Uq1, tuple1);
+        }
+
+        if (u_q0 > 0 && u_q1 > 0)
+          mel_encode(&mel, ojph_min(u_q0, u_q1) > 2);
+
+        if (u_q0 > 2 && u_q1 > 2)
+          uvlc_encode(&vlc, u_q0 - 2, u_q1 - 2);
+        else if (u_q0 > 2 && u_q1 > 0)
+        {
+          vlc_encode(&vlc, (ui32)ulvc_cwd_pre[u_q0], ulvc_cwd_pre_len[u_q0]);
+          vlc_encode(&vlc, (ui32)(u_q1 - 1), 1);
+          vlc_encode(&vlc, (ui32)ulvc_cwd_suf[u_q0], ulvc_cwd_suf_len[u_q0]);
+        }
+        else
+          uvlc_encode(&vlc, u_q0, u_q1);
+
+        //prepare for next iteration
+        c_q0 = (rho1 >> 1) | (rho1 & 1);
+      }
+
+      lep[1] = 0;
+
+      //non-initial lines of quads
+      for (ui32 y = 2; y < height; y += 2)
+      {
+        const si32* line = buf + y * stride;
+        analyse_quad_line<REVERSIBLE>(line, y + 1 < height ? line + stride
+                                                           : nullptr,
+                                      width, p, dropped_planes, inv_step,
+                                      &ql);
+        lep = e_val;
+        int max_e = ojph_max(lep[0], lep[1]) - 1;
+        lep[0] = 0;
+        lcxp = cx_val;
+        c_q0 = lcxp[0] + (lcxp[1] << 2);
+        lcxp[0] = 0;
+
+        for (ui32 x = 0, q = 0; x < width; x += 4, q += 2)
+        {
+          int rho0 = ql.rho[q], rho1 = 0;
+          int kappa = (rho0 & (rho0 - 1)) ? ojph_max(1, max_e) : 1;
+          int Uq0 = ojph_max((int)ql.e_max[4 * q], kappa);
+          int u_q0 = Uq0 - kappa, u_q1 = 0;
+          int eps0 = u_q0 > 0 ? ql.eps[q] : 0;
+
+          lep[0] = ojph_max(lep[0], (ui8)ql.e[4 * q + 1]); lep++;
+          max_e = ojph_max(lep[0], lep[1]) - 1;
+          lep[0] = (ui8)ql.e[4 * q + 3];
+          lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho0 & 2) >> 1)); lcxp++;
+          int c_q1 = lcxp[0] + (lcxp[1] << 2);
+          lcxp[0] = (ui8)((rho0 & 8) >> 3);
+
+          ui16 tuple0 = vlc_enc_tbl1[(c_q0 << 8) + (rho0 << 4) + eps0];
+          vlc_encode(&vlc, (ui32)(tuple0 >> 8), (tuple0 >> 4) & 7);
+          if (c_q0 == 0)
+            mel_encode(&mel, rho0 != 0);
+          ms_encode_quad(&ms, ql.s + 4 * q, rho0, Uq0, tuple0);
+
+          if (x + 2 < width)
+          {
+            rho1 = ql.rho[q + 1];
+            kappa = (rho1 & (rho1 - 1)) ? ojph_max(1, max_e) : 1;
+            c_q1 |= ((rho0 & 4) >> 1) | ((rho0 & 8) >> 2);
+            int Uq1 = ojph_max((int)ql.e_max[4 * q + 4], kappa);
+            u_q1 = Uq1 - kappa;
+            int eps1 = u_q1 > 0 ? ql.eps[q + 1] : 0;
+
+            lep[0] = ojph_max(lep[0], (ui8)ql.e[4 * q + 5]); lep++;
+            max_e = ojph_max(lep[0], lep[1]) - 1;
+            lep[0] = (ui8)ql.e[4 * q + 7];
+            lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho1 & 2) >> 1)); lcxp++;
+            c_q0 = lcxp[0] + (lcxp[1] << 2);
+            lcxp[0] = (ui8)((rho1 & 8) >> 3);
+
+            ui16 tuple1 = vlc_enc_tbl1[(c_q1 << 8) + (rho1 << 4) + eps1];
+            vlc_encode(&vlc, (ui32)(tuple1 >> 8), (tuple1 >> 4) & 7);
+            if (c_q1 == 0)
+              mel_encode(&mel, rho1 != 0);
+            ms_encode_quad(&ms, ql.s + 4 * q + 4, rho1, Uq1, tuple1);
+          }
+
+          uvlc_encode(&vlc, u_q0, u_q1);
+
+          //prepare for next iteration
+          c_q0 |= ((rho1 & 4) >> 1) | ((rho1 & 8) >> 2);
+        }
+      }
+
+      terminate_mel_vlc(&mel, &vlc);
+      ms_terminate(&ms);
+
+      //copy to elastic
+      lengths[0] = mel.pos + vlc.pos + ms.pos;
+      elastic->get_buffer(mel.pos + vlc.pos + ms.pos, coded);
+      memcpy(coded->buf, ms.buf, ms.pos);
+      memcpy(coded->buf + ms.pos, mel.buf, mel.pos);
+      memcpy(coded->buf + ms.pos + mel.pos, vlc.buf - vlc.pos + 1, vlc.pos);
+
+      // put in the interface locator word
+      ui32 num_bytes = mel.pos + vlc.pos;
+      coded->buf[lengths[0]-1] = (ui8)(num_bytes >> 4);
+      coded->buf[lengths[0]-2] = coded->buf[lengths[0]-2] & 0xF0;
+      coded->buf[lengths[0]-2] =
+        (ui8)(coded->buf[lengths[0]-2] | (num_bytes & 0xF));
+
+      coded->avail_size -= lengths[0];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ojph_encode_codeblock_avx2(const si32* buf, bool reversible,
+                                    float inv_step, ui32 missing_msbs,
+                                    ui32 dropped_planes, ui32 num_passes, ui32 width, ui32 height,
+                                    ui32 stride, ui32* lengths,
+                                    ojph::mem_elastic_allocator *elastic,
+                                    ojph::coded_lists *& coded)
+    {
+      assert(num_passes == 1);
+      (void)num_passes;                      //currently not used
+      if (reversible)
+        encode_codeblock<true>(buf, inv_step, missing_msbs, dropped_planes,
+                               width, height,
+                               stride, lengths, elastic, coded);
+      else
+        encode_codeblock<false>(buf, inv_step, missing_msbs, dropped_planes,
+                                width, height,
+                                stride, lengths, elastic, coded);
+    }
+  }
+}
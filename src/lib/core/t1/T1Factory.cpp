@@ -22,11 +22,17 @@
 
 namespace grk
 {
+// compressors released by finished tiles, oldest first
+static std::vector<std::pair<T1CompressorKey, T1Interface*>> freeCompressors;
+static std::mutex freeCompressorsMutex;
+
 T1Interface* T1Factory::makeT1(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
-							   uint32_t maxCblkH)
+							   uint32_t maxCblkH, GRK_HT_DECODER htDecoder,
+							   GRK_HT_ENCODER htEncoder)
 {
 	if(tcp->isHT())
-		return (T1Interface*)(new ojph::T1OJPH(isCompressor, tcp, maxCblkW, maxCblkH));
+		return (T1Interface*)(new ojph::T1OJPH(isCompressor, tcp, maxCblkW, maxCblkH, htDecoder,
+											   htEncoder));
 	return (T1Interface*)(new t1_part1::T1Part1(isCompressor, maxCblkW, maxCblkH));
 }
 
@@ -36,5 +42,49 @@ Quantizer* T1Factory::makeQuantizer(bool ht, bool reversible, uint8_t guardBits)
 		return (Quantizer*)(new ojph::QuantizerOJPH(reversible, guardBits));
 	return new Quantizer(reversible, guardBits);
 }
+T1Interface* T1Factory::acquireCompressor(TileCodingParams* tcp, T1CompressorKey key)
+{
+	assert(tcp->isHT() == key.ht);
+	{
+		std::unique_lock<std::mutex> lk(freeCompressorsMutex);
+		for(auto it = freeCompressors.rbegin(); it != freeCompressors.rend(); ++it)
+		{
+			if(it->first == key)
+			{
+				auto t1 = it->second;
+				freeCompressors.erase(std::next(it).base());
+				return t1;
+			}
+		}
+	}
+
+	return makeT1(true, tcp, key.maxCblkW, key.maxCblkH, GRK_HT_DECODER_AUTO, key.htEncoder);
+}
+void T1Factory::releaseCompressor(T1Interface* t1, T1CompressorKey key)
+{
+	if(!t1)
+		return;
+	// enough for a few tiles or images in flight; oldest compressors,
+	// which are the most likely to have stale geometry, are freed first
+	size_t maxFreeCompressors = 4 * ExecSingleton::get()->num_workers();
+	T1Interface* evicted = nullptr;
+	{
+		std::unique_lock<std::mutex> lk(freeCompressorsMutex);
+		freeCompressors.push_back(std::make_pair(key, t1));
+		if(freeCompressors.size() > maxFreeCompressors)
+		{
+			evicted = freeCompressors.front().second;
+			freeCompressors.erase(freeCompressors.begin());
+		}
+	}
+	delete evicted;
+}
+void T1Factory::releaseFreeCompressors(void)
+{
+	std::unique_lock<std::mutex> lk(freeCompressorsMutex);
+	for(auto& c : freeCompressors)
+		delete c.second;
+	freeCompressors.clear();
+}
 
 } // namespace grk
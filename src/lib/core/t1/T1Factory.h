@@ -21,12 +21,50 @@
 
 namespace grk
 {
+/**
+ * Code block geometry and coder selection of a compressor T1 instance
+ */
+struct T1CompressorKey
+{
+	bool operator==(const T1CompressorKey& rhs) const
+	{
+		return ht == rhs.ht && maxCblkW == rhs.maxCblkW && maxCblkH == rhs.maxCblkH &&
+			   htEncoder == rhs.htEncoder;
+	}
+	bool ht;
+	uint32_t maxCblkW;
+	uint32_t maxCblkH;
+	GRK_HT_ENCODER htEncoder;
+};
+
 class T1Factory
 {
   public:
 	static T1Interface* makeT1(bool isCompressor, TileCodingParams* tcp, uint32_t maxCblkW,
-							   uint32_t maxCblkH);
+							   uint32_t maxCblkH,
+							   GRK_HT_DECODER htDecoder = GRK_HT_DECODER_AUTO,
+							   GRK_HT_ENCODER htEncoder = GRK_HT_ENCODER_AUTO);
 	static Quantizer* makeQuantizer(bool ht, bool reversible, uint8_t guardBits);
+	/**
+	 * Get compressor T1, recycling one released by an earlier tile or image
+	 * with the same key, together with its coder state and scratch buffers (thread-safe)
+	 *
+	 * @param tcp tile coding parameters
+	 * @param key code block geometry and coder selection
+	 * @return compressor T1
+	 */
+	static T1Interface* acquireCompressor(TileCodingParams* tcp, T1CompressorKey key);
+	/**
+	 * Return compressor T1 to the process-wide free list (thread-safe)
+	 *
+	 * @param t1 compressor T1 returned by acquireCompressor
+	 * @param key key passed to acquireCompressor
+	 */
+	static void releaseCompressor(T1Interface* t1, T1CompressorKey key);
+	/**
+	 * Free compressors held in the process-wide free list
+	 */
+	static void releaseFreeCompressors(void);
 };
 
 } // namespace grk
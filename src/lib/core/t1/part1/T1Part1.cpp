@@ -152,19 +152,26 @@ namespace t1_part1
 				auto compressedData = t1->getCompressedDataBuffer();
 				for(auto& b : cblk->seg_buffers)
 				{
-					memcpy(compressedData + offset, b->buf, b->len);
-					offset += b->len;
+					memcpy(compressedData + offset, b.buf, b.len);
+					offset += b.len;
 				}
 				bool ret = t1->decompress_cblk(cblk, compressedData, block->bandOrientation,
 											   block->cblk_sty);
-				cblk->setCacheState(ret ? GRK_CACHE_STATE_OPEN : GRK_CACHE_STATE_ERROR);
 				if(!ret)
+				{
+					cblk->setCacheState(GRK_CACHE_STATE_ERROR);
 					return false;
+				}
+				if(!block->keepCompressedData)
+					cblk->setCacheState(GRK_CACHE_STATE_OPEN);
 			}
 		}
 
 		block->tilec->postProcess(t1->getUncompressedData(), block);
-		cblk->release();
+		if(block->keepCompressedData)
+			cblk->releaseUncompressedData();
+		else
+			cblk->release();
 
 		return true;
 	}
@@ -0,0 +1,172 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+// estimated bits for a sample that is insignificant after dropping bit planes:
+// runs of insignificant quads are cheap to code with the MEL coder
+const double htInsignificantSampleBits = 1.0 / 32;
+
+HTBandStats::HTBandStats(double weight, uint8_t maxDroppedPlanes, bool reversible)
+	: weight(weight), calibration(1.0), codedBytes(0), droppedPlanes(0), codedPlanes(0),
+	  maxDroppedPlanes(maxDroppedPlanes), reversible(reversible)
+{
+	memset(count, 0, sizeof(count));
+	memset(sumSquares, 0, sizeof(sumSquares));
+	for(uint32_t b = 0; b < 32; ++b)
+		measuredBytes[b] = -1;
+}
+void HTBandStats::add(const uint32_t* blockCount, const double* blockSumSquares)
+{
+	std::unique_lock<std::mutex> lk(mutex);
+	for(uint32_t b = 0; b < 32; ++b)
+	{
+		count[b] += blockCount[b];
+		sumSquares[b] += blockSumSquares[b];
+	}
+}
+/*
+ A significant sample costs, roughly, its magnitude bits plus a sign bit,
+ and an insignificant sample a fraction of a bit of MEL/VLC context coding.
+ The model is scaled to the band's actual coded size by calibrate(), and
+ is only used for allocations that have not yet been coded.
+ */
+double HTBandStats::estimateBits(uint8_t planes) const
+{
+	if(measuredBytes[planes] >= 0)
+		return (double)measuredBytes[planes] * 8.0;
+
+	return modelBits(planes) * calibration;
+}
+double HTBandStats::modelBits(uint8_t planes) const
+{
+	double bits = 0;
+	for(uint32_t b = 0; b < 32; ++b)
+	{
+		if(b > planes)
+			bits += (double)count[b] * (double)(b - planes + 1);
+		else
+			bits += (double)count[b] * htInsignificantSampleBits;
+	}
+
+	return bits;
+}
+/*
+ Samples whose magnitude lies entirely in the dropped bit planes are
+ reconstructed as zero, with squared error equal to their squared magnitude.
+ The remaining samples are reconstructed at the mid-point of the dropped
+ interval, with a uniformly distributed error.
+ */
+double HTBandStats::estimateDistortion(uint8_t planes) const
+{
+	double interval = (double)((uint64_t)1 << planes);
+	double uniform = reversible ? (interval * interval - 1) / 12.0 : interval * interval / 12.0;
+	double baseline = reversible ? 0 : 1.0 / 12.0;
+	double distortion = 0;
+	for(uint32_t b = 0; b < 32; ++b)
+	{
+		if(b > planes)
+			distortion += (double)count[b] * uniform;
+		else
+			distortion += sumSquares[b] + (double)count[b] * baseline;
+	}
+
+	return distortion * weight;
+}
+void HTBandStats::calibrate(void)
+{
+	measuredBytes[codedPlanes] = (int64_t)codedBytes;
+	// a band with no significant samples at codedPlanes keeps its previous calibration
+	double modelled = modelBits(codedPlanes);
+	if(codedBytes && modelled > 0)
+		calibration = (double)codedBytes * 8.0 / modelled;
+}
+void HTRateControl::allocate(std::vector<HTBandStats*>& bands, double maxBytes,
+							 double maxDistortion)
+{
+	if(bands.empty())
+		return;
+	// bytes and distortion for each band and number of dropped bit planes
+	const uint32_t maxPlanes = 32;
+	std::vector<double> bytes(bands.size() * maxPlanes);
+	std::vector<double> distortion(bands.size() * maxPlanes);
+	for(size_t i = 0; i < bands.size(); ++i)
+	{
+		auto band = bands[i];
+		band->calibrate();
+		for(uint8_t planes = 0; planes <= band->maxDroppedPlanes; ++planes)
+		{
+			bytes[i * maxPlanes + planes] = band->estimateBits(planes) / 8.0;
+			distortion[i * maxPlanes + planes] = band->estimateDistortion(planes);
+		}
+	}
+	// choose planes that minimize distortion + lambda * bytes, for each band
+	auto select = [&](double lambda, double* totalBytes, double* totalDistortion) {
+		*totalBytes = 0;
+		*totalDistortion = 0;
+		for(size_t i = 0; i < bands.size(); ++i)
+		{
+			auto band = bands[i];
+			auto r = bytes.data() + i * maxPlanes;
+			auto d = distortion.data() + i * maxPlanes;
+			uint8_t best = 0;
+			for(uint8_t planes = 1; planes <= band->maxDroppedPlanes; ++planes)
+			{
+				if(d[planes] + lambda * r[planes] < d[best] + lambda * r[best])
+					best = planes;
+			}
+			band->droppedPlanes = best;
+			*totalBytes += r[best];
+			*totalDistortion += d[best];
+		}
+	};
+	// bisect on log2(lambda) : larger lambda gives lower rate and higher distortion
+	double lower = -64;
+	double upper = 128;
+	double totalBytes, totalDistortion;
+	for(uint32_t i = 0; i < 64; ++i)
+	{
+		double mid = (lower + upper) / 2;
+		select(pow(2.0, mid), &totalBytes, &totalDistortion);
+		bool feasible =
+			maxDistortion > 0 ? totalDistortion <= maxDistortion : totalBytes <= maxBytes;
+		// byte budget: smallest feasible lambda; distortion budget: largest feasible lambda
+		if(feasible == (maxDistortion <= 0))
+			upper = mid;
+		else
+			lower = mid;
+	}
+	select(pow(2.0, maxDistortion > 0 ? lower : upper), &totalBytes, &totalDistortion);
+}
+bool HTRateControl::dropPlane(std::vector<HTBandStats*>& bands)
+{
+	bool dropped = false;
+	for(auto band : bands)
+	{
+		if(band->droppedPlanes < band->maxDroppedPlanes)
+		{
+			band->droppedPlanes++;
+			dropped = true;
+		}
+	}
+
+	return dropped;
+}
+
+} // namespace grk
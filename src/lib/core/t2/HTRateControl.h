@@ -0,0 +1,111 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+namespace grk
+{
+/**
+ * Statistics of the quantized magnitudes of a sub-band, gathered
+ * by the HT block coder, together with the band's current allocation.
+ *
+ * The HT coder emits a single cleanup pass, so there are no truncation points
+ * for PCRD. Instead, the effective quantization step of each band is
+ * scaled by 2^droppedPlanes, by discarding least significant bit planes
+ * of the quantized magnitudes and signalling them as missing through the
+ * code block's number of bit planes.
+ */
+struct HTBandStats
+{
+	HTBandStats(double weight, uint8_t maxDroppedPlanes, bool reversible);
+	/**
+	 * Add code block statistics (thread-safe)
+	 *
+	 * @param count number of samples with each bit length of quantized magnitude
+	 * @param sumSquares sum of squared quantized magnitudes, for each bit length
+	 */
+	void add(const uint32_t* count, const double* sumSquares);
+	/**
+	 * Estimate coded bits when dropping least significant bit planes
+	 *
+	 * @param planes number of dropped bit planes
+	 * @return estimated bits
+	 */
+	double estimateBits(uint8_t planes) const;
+	/**
+	 * Estimate weighted squared error when dropping least significant bit planes
+	 *
+	 * @param planes number of dropped bit planes
+	 * @return estimated distortion
+	 */
+	double estimateDistortion(uint8_t planes) const;
+	/**
+	 * Record coded size of band at codedPlanes, and calibrate bit estimates with it
+	 */
+	void calibrate(void);
+
+	// number of samples with each bit length of quantized magnitude
+	uint64_t count[32];
+	// sum of squared quantized magnitudes, for each bit length
+	double sumSquares[32];
+	// (mct norm * dwt norm * step size)^2
+	double weight;
+	// ratio of coded bits to estimated bits
+	double calibration;
+	// bytes coded by all blocks in band, at codedPlanes dropped bit planes
+	std::atomic<uint64_t> codedBytes;
+	// coded bytes for each number of dropped bit planes, or -1 if not yet coded
+	int64_t measuredBytes[32];
+	// number of dropped bit planes selected by rate control
+	uint8_t droppedPlanes;
+	// number of dropped bit planes of most recent compress
+	uint8_t codedPlanes;
+	// band's number of bit planes minus one
+	uint8_t maxDroppedPlanes;
+	bool reversible;
+
+  private:
+	/**
+	 * Estimate coded bits when dropping least significant bit planes, before calibration
+	 */
+	double modelBits(uint8_t planes) const;
+
+	std::mutex mutex;
+};
+
+class HTRateControl
+{
+  public:
+	/**
+	 * Select the number of dropped bit planes for each band, by bisecting on
+	 * the Lagrange multiplier. Minimizes distortion subject to byte budget,
+	 * or rate subject to distortion budget, if maxDistortion is positive
+	 *
+	 * @param bands bands
+	 * @param maxBytes byte budget
+	 * @param maxDistortion distortion budget, or zero for byte budget
+	 */
+	static void allocate(std::vector<HTBandStats*>& bands, double maxBytes, double maxDistortion);
+	/**
+	 * Drop one more bit plane from every band that has a bit plane left to drop
+	 *
+	 * @param bands bands
+	 * @return false if no band has any bit planes left to drop
+	 */
+	static bool dropPlane(std::vector<HTBandStats*>& bands);
+};
+
+} // namespace grk
@@ -417,8 +417,7 @@ void PacketParser::readData(void)
 					// correct for truncated packet
 					if(seg->numBytesInPacket > remainingTilePartBytes_)
 						seg->numBytesInPacket = (uint32_t)remainingTilePartBytes_;
-					cblk->seg_buffers.push_back(
-						new grk_buf8(data_ + offset, seg->numBytesInPacket, false));
+					cblk->seg_buffers.emplace_back(data_ + offset, seg->numBytesInPacket, false);
 					offset += seg->numBytesInPacket;
 					cblk->compressedStream.len += seg->numBytesInPacket;
 					seg->len += seg->numBytesInPacket;
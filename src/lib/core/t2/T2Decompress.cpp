@@ -123,17 +123,30 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 			}
 		}
 	}
-	if(!skip || !packetInfo->packetLength)
+	// with a packet length from PL markers, a skipped packet needs
+	// neither precincts nor a header parse: jump straight past it
+	if(skip && packetInfo->packetLength)
 	{
-		for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+		try
 		{
-			auto band = res->tileBand + bandIndex;
-			if(band->empty())
-				continue;
-			if(!band->createPrecinct(tileProcessor, precinctIndex, res->precinctPartitionTopLeft,
-									 res->precinctExpn, res->precinctGridWidth, res->cblkExpn))
-				return false;
+			src->incrementCurrentChunkOffset(packetInfo->packetLength);
 		}
+		catch([[maybe_unused]] SparseBufferOverrunException& sboe)
+		{
+			return false;
+		}
+		tileProcessor->incNumProcessedPackets();
+
+		return true;
+	}
+	for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+	{
+		auto band = res->tileBand + bandIndex;
+		if(band->empty())
+			continue;
+		if(!band->createPrecinct(tileProcessor, precinctIndex, res->precinctPartitionTopLeft,
+								 res->precinctExpn, res->precinctGridWidth, res->cblkExpn))
+			return false;
 	}
 	auto parser = new PacketParser(tileProcessor, tileProcessor->getNumProcessedPackets() & 0xFFFF,
 								   compno, resno, precinctIndex, layno, src->getCurrentChunkPtr(),
@@ -152,6 +165,7 @@ bool T2Decompress::processPacket(uint16_t compno, uint8_t resno, uint64_t precin
 			throw;
 		}
 		packetLen = parser->numHeaderBytes() + parser->numSignalledDataBytes();
+		tileProcessor->packetLengthCache.record(packetLen);
 	}
 	try
 	{
@@ -345,6 +345,10 @@ bool TileComponent::isWholeTileDecoding()
 {
 	return wholeTileDecompress;
 }
+void TileComponent::setWholeTileDecoding(bool wholeTile)
+{
+	wholeTileDecompress = wholeTile;
+}
 ISparseCanvas* TileComponent::getRegionWindow()
 {
 	return regionWindow_;
@@ -412,8 +416,7 @@ void TileComponent::postDecompressImpl(int32_t* srcData, DecompressBlockExec* bl
 		}
 	}
 	if(regionWindow_)
-		regionWindow_->write(block->resno, blockBounds, empty ? nullptr : srcData, 1,
-							 blockBounds.width());
+		regionWindow_->write(block->resno, blockBounds, empty ? nullptr : srcData, 1, stride);
 }
 
 } // namespace grk
@@ -38,6 +38,7 @@ struct TileComponent : public grk_rect32
 
 	TileComponentWindow<int32_t>* getWindow() const;
 	bool isWholeTileDecoding();
+	void setWholeTileDecoding(bool wholeTile);
 	ISparseCanvas* getRegionWindow();
 	void postProcess(int32_t* srcData, DecompressBlockExec* block);
 	void postProcessHT(int32_t* srcData, DecompressBlockExec* block, uint16_t stride);
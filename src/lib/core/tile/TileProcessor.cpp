@@ -31,7 +31,8 @@ TileProcessor::TileProcessor(uint16_t tileIndex, CodeStream* codeStream, Buffere
 	  tileIndex_(tileIndex), stream_(stream),
 	  newTilePartProgressionPosition(cp_->coding_params_.enc_.newTilePartProgressionPosition),
 	  tcp_(cp_->tcps + tileIndex_), truncated(false), image_(nullptr), isCompressor_(isCompressor),
-	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache))
+	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache)),
+	  stripCache_(stripCache), codeBlocksCached_(false)
 {}
 TileProcessor::~TileProcessor()
 {
@@ -169,9 +170,59 @@ void TileProcessor::release(GRK_TILE_CACHE_STRATEGY strategy)
 		image_ = nullptr;
 	}
 
+	// LRU tile cache may keep parsed code blocks, so that tile
+	// can be decompressed again without T2
+	if(strategy == GRK_TILE_CACHE_LRU && codeBlocksCached_)
+		return;
+
 	// delete tile components
 	delete tile;
 	tile = nullptr;
+	codeBlocksCached_ = false;
+}
+void TileProcessor::evict(void)
+{
+	release(GRK_TILE_CACHE_NONE);
+	auto tcp = getTileCodingParams();
+	delete tcp->compressedTileData_;
+	tcp->compressedTileData_ = nullptr;
+}
+bool TileProcessor::cacheImage(GrkImage* src)
+{
+	if(image_)
+		grk_object_unref(&image_->obj);
+	image_ = new GrkImage();
+	src->copyHeader(image_);
+	if(!src->copyDataTo(image_))
+	{
+		grk_object_unref(&image_->obj);
+		image_ = nullptr;
+		return false;
+	}
+
+	return true;
+}
+uint64_t TileProcessor::getCachedBytes(void)
+{
+	uint64_t bytes = 0;
+	if(image_)
+	{
+		for(uint16_t compno = 0; compno < image_->numcomps; ++compno)
+		{
+			auto comp = image_->comps + compno;
+			if(comp->data)
+				bytes += (uint64_t)comp->stride * comp->h * sizeof(int32_t);
+		}
+	}
+	auto tcp = getTileCodingParams();
+	if(codeBlocksCached_ && tcp->compressedTileData_)
+		bytes += tcp->compressedTileData_->totalLength();
+
+	return bytes;
+}
+bool TileProcessor::hasCachedCodeBlocks(void)
+{
+	return codeBlocksCached_;
 }
 PacketTracker* TileProcessor::getPacketTracker(void)
 {
@@ -203,6 +254,14 @@ bool TileProcessor::init(void)
 	uint32_t state = grk_plugin_get_debug_state();
 	auto tcp = &(cp_->tcps[tileIndex_]);
 
+	// tile is released after decompression, so re-create it
+	// if this tile is being decompressed again
+	if(!tile)
+	{
+		tile = new Tile(headerImage->numcomps);
+		delete mct_;
+		mct_ = new mct(tile, headerImage, tcp_, stripCache_);
+	}
 	if(tcp->compressedTileData_)
 		tcp->compressedTileData_->rewind();
 
@@ -265,6 +324,13 @@ bool TileProcessor::init(void)
 	return true;
 }
 bool TileProcessor::createWindowBuffers(const GrkImage* outputImage)
+{
+	// compressor windows cover entire tile, so there is no output image
+	return createWindowBuffers(
+		outputImage ? grk_rect32(outputImage->x0, outputImage->y0, outputImage->x1, outputImage->y1)
+					: grk_rect32(0, 0, 0, 0));
+}
+bool TileProcessor::createWindowBuffers(grk_rect32 unreducedWindow)
 {
 	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
 	{
@@ -281,8 +347,7 @@ bool TileProcessor::createWindowBuffers(const GrkImage* outputImage)
 		}
 		else
 		{
-			unreducedImageWindow =
-				grk_rect32(outputImage->x0, outputImage->y0, outputImage->x1, outputImage->y1);
+			unreducedImageWindow = unreducedWindow;
 			unreducedImageCompWindow =
 				unreducedImageWindow.scaleDownCeil(imageComp->dx, imageComp->dy);
 			if(!tileComp->canCreateWindow(unreducedImageCompWindow))
@@ -445,6 +510,13 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 	bool doPostT1 =
 		!current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_POST_T1);
 
+	// when decompressing again from cached code blocks, the decompress
+	// window may have changed since the tile was parsed
+	if(codeBlocksCached_)
+	{
+		for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+			(tile->comps + compno)->setWholeTileDecoding(cp_->wholeTileDecompress_);
+	}
 	// create window buffers
 	// (no buffer allocation)
 	if(!createWindowBuffers(outputImage))
@@ -460,11 +532,39 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 			break;
 		}
 	}
-	bool doT2 = !current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T2);
+	bool doT2 = (!current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T2)) &&
+				!codeBlocksCached_;
 	if(doT2)
 	{
+		// to cache code blocks for any future window, all packets must be parsed
+		bool cacheCodeBlocks = cp_->coding_params_.dec_.tileCacheCodeBlocks_;
+		if(cacheCodeBlocks && !createWindowBuffers(grk_rect32(tile->x0, tile->y0, tile->x1, tile->y1)))
+			return false;
+		// packet lengths from code stream index stand in for missing PLT markers
+		auto index = cp_->codeStreamIndex_;
+		bool packedHeaders = cp_->ppm_marker || tcp->ppt_markers;
+		if(index && !packedHeaders && !packetLengthCache.getMarkers())
+		{
+			auto lengths = index->getPacketLengths(tileIndex_);
+			if(lengths)
+				packetLengthCache.createMarkers(nullptr)->setPacketLengths(*lengths);
+		}
 		auto t2 = std::make_unique<T2Decompress>(this);
 		t2->decompressPackets(tileIndex_, tcp->compressedTileData_, &truncated);
+		if(index && !packedHeaders && !truncated)
+		{
+			uint64_t numPackets = 0;
+			for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+			{
+				auto tilec = getTile()->comps + compno;
+				for(uint8_t resno = 0; resno < tilec->numresolutions; ++resno)
+				{
+					auto res = tilec->resolutions_ + resno;
+					numPackets += (uint64_t)res->precinctGridWidth * res->precinctGridHeight;
+				}
+			}
+			packetLengthCache.commit(tileIndex_, numPackets * tcp->numlayers);
+		}
 		// synch plugin with T2 data
 		// todo re-enable decompress synch
 		// decompress_synch_plugin_with_host(this);
@@ -548,10 +648,16 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 						}
 					}
 				}
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] tasks;
 			}
 		}
+		if(cacheCodeBlocks)
+		{
+			if(!createWindowBuffers(outputImage))
+				return false;
+			codeBlocksCached_ = !truncated;
+		}
 	}
 	// T1
 	if(doT1)
@@ -823,7 +929,8 @@ void TileProcessor::t1_encode()
 		mct_norms = (const double*)(tcp->mct_norms);
 	}
 
-	scheduler_ = new CompressScheduler(tile, needsRateControl(), tcp, mct_norms, mct_numcomps);
+	scheduler_ = new CompressScheduler(tile, needsRateControl(), tcp, mct_norms, mct_numcomps,
+									   cp_->coding_params_.enc_.htEncoder);
 	scheduler_->schedule(0);
 }
 bool TileProcessor::encodeT2(uint32_t* tileBytesWritten)
@@ -1136,6 +1243,9 @@ bool TileProcessor::cacheTilePartPackets(CodeStreamDecompress* codeStream)
 // RATE CONTROL ////////////////////////////////////////////
 bool TileProcessor::rateAllocate(uint32_t* allPacketBytes, bool disableRateControl)
 {
+	// HT code blocks have no truncation points
+	if(tcp_->isHT() && needsRateControl())
+		return htRateAllocate(allPacketBytes, disableRateControl);
 	// rate control by rate/distortion or fixed quality
 	switch(cp_->coding_params_.enc_.rateControlAlgorithm)
 	{
@@ -1400,6 +1510,103 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 	// assert(!disableRateControl || rc);
 	return rc;
 }
+/*
+ Rate control for HT code blocks, which have a single cleanup pass and
+ therefore no truncation points. Least significant bit planes are dropped
+ from each band, as selected by HTRateControl from statistics gathered when
+ the blocks were first compressed. Bands whose allocation changes are compressed
+ again, and the byte budget is corrected by the simulated tile length, until
+ the tile fits.
+ */
+bool TileProcessor::htRateAllocate(uint32_t* allPacketBytes, bool disableRateControl)
+{
+	auto scheduler = (CompressScheduler*)scheduler_;
+	auto& bands = scheduler->getHTBands();
+	auto t2 = T2Compress(this);
+	auto simulate = [&](uint32_t maxLayerLength, bool finalSimulation) {
+		return t2.compressPacketsSimulate(tileIndex_, 1, allPacketBytes, maxLayerLength,
+										  newTilePartProgressionPosition,
+										  packetLengthCache.getMarkers(), finalSimulation, false);
+	};
+	auto recompress = [&]() {
+		scheduler->recompressHT();
+		makeLayerFinal(0);
+		return simulate(UINT_MAX, false);
+	};
+	if(disableRateControl)
+	{
+		makeLayerFinal(0);
+		return simulate(UINT_MAX, true);
+	}
+	uint32_t maxLayerLength =
+		tcp_->rates[0] > 0.0f ? ((uint32_t)ceil(tcp_->rates[0])) : UINT_MAX;
+	double maxDistortion = 0;
+	if(cp_->coding_params_.enc_.allocationByFixedQuality_ && tcp_->distortion[0] > 0.0)
+	{
+		const double K = 1;
+		double maxSE = 0;
+		for(uint16_t compno = 0; compno < tile->numcomps_; compno++)
+		{
+			double maxValue = (double)(((uint64_t)1 << headerImage->comps[compno].prec) - 1);
+			maxSE += maxValue * maxValue * (double)tile->comps[compno].area();
+		}
+		maxDistortion = (K * maxSE) / pow(10.0, tcp_->distortion[0] / 10.0);
+	}
+
+	// allocation with the largest tile length that fits
+	std::vector<uint8_t> best;
+	uint32_t bestBytes = 0;
+	double maxBytes = maxLayerLength;
+	for(uint32_t i = 0; i < 8; ++i)
+	{
+		HTRateControl::allocate(bands, maxBytes, maxDistortion);
+		bool changed = i == 0;
+		for(auto band : bands)
+			changed |= band->droppedPlanes != band->codedPlanes;
+		if(!changed)
+			break;
+		if(!recompress())
+			return false;
+		bool fits = *allPacketBytes <= maxLayerLength;
+		if(fits && (best.empty() || *allPacketBytes > bestBytes))
+		{
+			best.clear();
+			for(auto band : bands)
+				best.push_back(band->droppedPlanes);
+			bestBytes = *allPacketBytes;
+		}
+		if(maxDistortion > 0 || (fits && *allPacketBytes >= 0.98 * maxLayerLength))
+			break;
+		// budget for code blocks excludes packet headers
+		double codeBlockBytes = 0;
+		for(auto band : bands)
+			codeBlockBytes += (double)band->codedBytes;
+		maxBytes = (double)maxLayerLength - ((double)*allPacketBytes - codeBlockBytes);
+	}
+	if(best.empty())
+	{
+		while(*allPacketBytes > maxLayerLength && HTRateControl::dropPlane(bands))
+		{
+			if(!recompress())
+				return false;
+		}
+	}
+	else
+	{
+		bool changed = false;
+		for(size_t i = 0; i < bands.size(); ++i)
+		{
+			changed |= bands[i]->droppedPlanes != best[i];
+			bands[i]->droppedPlanes = best[i];
+		}
+		if(changed && !recompress())
+			return false;
+	}
+
+	// final simulation will generate correct PLT lengths
+	// and correct tile length
+	return simulate(maxLayerLength, true);
+}
 /*
  Simple bisect algorithm to calculate optimal layer truncation points
  */
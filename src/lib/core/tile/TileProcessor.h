@@ -81,6 +81,7 @@ struct TileProcessor
 	~TileProcessor();
 	bool init(void);
 	bool createWindowBuffers(const GrkImage* outputImage);
+	bool createWindowBuffers(grk_rect32 unreducedImageWindow);
 	void deallocBuffers();
 	bool preCompressTile(void);
 	bool canWritePocMarker(void);
@@ -94,6 +95,28 @@ struct TileProcessor
 	void generateImage(GrkImage* src_image, Tile* src_tile);
 	GrkImage* getImage(void);
 	void release(GRK_TILE_CACHE_STRATEGY strategy);
+	/**
+	 * Release image, code blocks and compressed tile data.
+	 * The tile will be read again from the code stream if it is requested again
+	 */
+	void evict(void);
+	/**
+	 * Store copy of decompressed image, so that it can be served from cache
+	 *
+	 * @param src decompressed image
+	 * @return true if successful
+	 */
+	bool cacheImage(GrkImage* src);
+	/**
+	 * Get approximate number of bytes held for tile cache: image data,
+	 * and compressed data referenced by cached code blocks
+	 */
+	uint64_t getCachedBytes(void);
+	/**
+	 * @return true if parsed code blocks for entire tile have been kept, so that
+	 * tile can be decompressed again, at any window, without T2
+	 */
+	bool hasCachedCodeBlocks(void);
 	void setCorruptPacket(void);
 	PacketTracker* getPacketTracker(void);
 	grk_rect32 getUnreducedTileWindow(void);
@@ -151,6 +174,7 @@ struct TileProcessor
 	void makeLayerSimple(uint32_t layno, double thresh, bool finalAttempt);
 	bool pcrdBisectFeasible(uint32_t* p_data_written, bool disableRateControl);
 	bool makeLayerFeasible(uint32_t layno, uint16_t thresh, bool finalAttempt);
+	bool htRateAllocate(uint32_t* allPacketBytes, bool disableRateControl);
 
 	Tile* tile;
 	Scheduler* scheduler_;
@@ -175,6 +199,8 @@ struct TileProcessor
 	grk_rect32 unreducedImageWindow;
 	uint32_t preCalculatedTileLen;
 	mct* mct_;
+	StripCache* stripCache_;
+	bool codeBlocksCached_;
 };
 
 } // namespace grk
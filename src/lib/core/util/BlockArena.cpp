@@ -0,0 +1,120 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+
+/* #define GRK_DEBUG_ARENA */
+
+namespace grk
+{
+// chunks released by arenas, available for reuse
+static std::vector<uint8_t*> freeChunks;
+static std::mutex freeChunksMutex;
+// keep free list from pinning memory after a very large tile
+static const size_t maxFreeChunks = 256;
+
+static std::atomic<uint64_t> statAllocations(0);
+static std::atomic<uint64_t> statChunkAllocations(0);
+static std::atomic<uint64_t> statChunkReuses(0);
+
+BlockArena::BlockArena(void) : curr_(nullptr), end_(nullptr), numAllocations_(0) {}
+BlockArena::~BlockArena(void)
+{
+	reset();
+}
+void* BlockArena::alloc(size_t size, size_t align)
+{
+	assert(size <= chunkSize);
+	assert((align & (align - 1)) == 0);
+	auto ptr = (uint8_t*)(((uintptr_t)curr_ + align - 1) & ~(uintptr_t)(align - 1));
+	if(!curr_ || ptr + size > end_)
+	{
+		if(!nextChunk())
+			return nullptr;
+		ptr = curr_;
+	}
+	curr_ = ptr + size;
+	numAllocations_++;
+
+	return ptr;
+}
+bool BlockArena::nextChunk(void)
+{
+	uint8_t* chunk = nullptr;
+	{
+		std::unique_lock<std::mutex> lk(freeChunksMutex);
+		if(!freeChunks.empty())
+		{
+			chunk = freeChunks.back();
+			freeChunks.pop_back();
+		}
+	}
+	if(chunk)
+	{
+		statChunkReuses++;
+	}
+	else
+	{
+		chunk = (uint8_t*)grk_aligned_malloc(chunkSize);
+		if(!chunk)
+			return false;
+		statChunkAllocations++;
+	}
+	chunks_.push_back(chunk);
+	curr_ = chunk;
+	end_ = chunk + chunkSize;
+
+	return true;
+}
+void BlockArena::reset(void)
+{
+	statAllocations += numAllocations_;
+	numAllocations_ = 0;
+	curr_ = nullptr;
+	end_ = nullptr;
+	if(chunks_.empty())
+		return;
+	{
+		std::unique_lock<std::mutex> lk(freeChunksMutex);
+		while(!chunks_.empty() && freeChunks.size() < maxFreeChunks)
+		{
+			freeChunks.push_back(chunks_.back());
+			chunks_.pop_back();
+		}
+	}
+	for(auto& ch : chunks_)
+		grk_aligned_free(ch);
+	chunks_.clear();
+}
+BlockArenaStats BlockArena::getStats(void)
+{
+	return {statAllocations, statChunkAllocations, statChunkReuses};
+}
+void BlockArena::releaseFreeChunks(void)
+{
+#ifdef GRK_DEBUG_ARENA
+	auto stats = getStats();
+	GRK_INFO("Block arena: %" PRIu64 " allocations, %" PRIu64 " chunks allocated, %" PRIu64
+			 " chunks reused",
+			 stats.numAllocations, stats.numChunkAllocations, stats.numChunkReuses);
+#endif
+	std::unique_lock<std::mutex> lk(freeChunksMutex);
+	for(auto& ch : freeChunks)
+		grk_aligned_free(ch);
+	freeChunks.clear();
+}
+
+} // namespace grk
@@ -0,0 +1,99 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace grk
+{
+/**
+ * Arena statistics, accumulated over all arenas in the process
+ */
+struct BlockArenaStats
+{
+	/* number of objects allocated from arenas */
+	uint64_t numAllocations;
+	/* number of arena chunks allocated on the heap */
+	uint64_t numChunkAllocations;
+	/* number of arena chunks reused from the free list */
+	uint64_t numChunkReuses;
+};
+
+/**
+ * Bump allocator for short-lived objects that are created together and
+ * destroyed together, such as the block executors scheduled for one tile.
+ *
+ * Objects are carved out of fixed size chunks and are never freed
+ * individually: all memory is reclaimed when the arena is reset or destroyed.
+ * Released chunks go to a process-wide free list, so that the next tile
+ * recycles them rather than going back to the heap.
+ *
+ * Allocation is not thread safe.
+ */
+class BlockArena
+{
+  public:
+	BlockArena(void);
+	~BlockArena(void);
+	/**
+	 * Allocate memory from arena
+	 *
+	 * @param size number of bytes; must not be larger than chunk size
+	 * @param align alignment, which must be a power of two
+	 * @return pointer to memory, or nullptr if out of memory
+	 */
+	void* alloc(size_t size, size_t align);
+	template<typename T, typename... Args>
+	T* make(Args&&... args)
+	{
+		static_assert(sizeof(T) <= chunkSize);
+		auto mem = alloc(sizeof(T), alignof(T));
+		if(!mem)
+			throw std::bad_alloc();
+		return new(mem) T(std::forward<Args>(args)...);
+	}
+	/**
+	 * Destroy object allocated with make(). Memory is reclaimed on reset
+	 */
+	template<typename T>
+	static void destroy(T* obj)
+	{
+		if(obj)
+			obj->~T();
+	}
+	/**
+	 * Reclaim all memory. Objects must have been destroyed beforehand
+	 */
+	void reset(void);
+	static BlockArenaStats getStats(void);
+	/**
+	 * Free chunks held in the process-wide free list
+	 */
+	static void releaseFreeChunks(void);
+
+  private:
+	static constexpr size_t chunkSize = 64 * 1024;
+	bool nextChunk(void);
+	std::vector<uint8_t*> chunks_;
+	uint8_t* curr_;
+	uint8_t* end_;
+	uint64_t numAllocations_;
+};
+
+} // namespace grk
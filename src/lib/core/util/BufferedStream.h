@@ -47,6 +47,17 @@ struct BufferedStream
 	void setZeroCopyReadFunction(grk_stream_zero_copy_read_fn fn);
 	void setWriteFunction(grk_stream_write_fn fn);
 	void setSeekFunction(grk_stream_seek_fn fn);
+	void setPrefetchFunction(grk_stream_prefetch_fn fn);
+	/**
+	 * Check if client has registered a prefetch function
+	 */
+	bool hasPrefetch(void);
+	/**
+	 * Notify client of byte ranges that are about to be read
+	 *
+	 * @param ranges byte ranges, in stream order
+	 */
+	void prefetch(const std::vector<grk_stream_range>& ranges);
 	/**
 	 * Reads some bytes from the stream.
 	 * @param		buffer	pointer to the data buffer
@@ -191,6 +202,10 @@ struct BufferedStream
 	 * Pointer to actual seek function (if available).
 	 */
 	grk_stream_seek_fn seek_fn_;
+	/**
+	 * Pointer to prefetch function (if available).
+	 */
+	grk_stream_prefetch_fn prefetch_fn_;
 	/**
 	 * Stream status flags
 	 */
@@ -324,10 +324,14 @@ bool GrkImage::supportsStripCache(CodingParams* cp)
 	}
 	else
 	{
-		// only mono supported
-		if(numcomps > 1)
+		// strips are interleaved from the tile's MCT / DC shift stage,
+		// which does not support custom MCT
+		if(cp->tcps->mct == 2)
 			return false;
 	}
+	// all decompressed components must be serialized
+	if(decompressNumComps != numcomps)
+		return false;
 
 	// difference between image origin y coordinate and tile origin y coordinate
 	// must be multiple of the tile height, so that only the final strip may have
@@ -336,10 +340,21 @@ bool GrkImage::supportsStripCache(CodingParams* cp)
 	if(((y0 - cp->ty0) % cp->t_height) != 0)
 		return false;
 
-	bool supportedFileFormat =
-		decompressFormat == GRK_FMT_TIF || (decompressFormat == GRK_FMT_PXM && !splitByComponent);
+	// PNG rows are written as is, so only native PNG precisions are supported
+	bool supportedPNG = decompressFormat == GRK_FMT_PNG && numcomps <= 4 && !comps->sgnd &&
+						(comps->prec == 8 || comps->prec == 16);
+	bool supportedFileFormat = decompressFormat == GRK_FMT_TIF || supportedPNG ||
+							   (decompressFormat == GRK_FMT_PXM && !splitByComponent);
 	if(isSubsampled() || precision || upsample || needsConversionToRGB() || !supportedFileFormat ||
-	   (meta && (meta->color.palette || meta->color.icc_profile_buf)))
+	   (meta && meta->color.palette))
+	{
+		return false;
+	}
+	// TIFF and PNG can store an ICC profile, so it is not applied to the pixels,
+	// but CIE colour spaces must be converted to RGB
+	if(meta && meta->color.icc_profile_buf &&
+	   (decompressFormat == GRK_FMT_PXM || color_space == GRK_CLRSPC_DEFAULT_CIE ||
+		color_space == GRK_CLRSPC_CUSTOM_CIE))
 	{
 		return false;
 	}
@@ -903,6 +918,33 @@ void GrkImage::transferDataTo(GrkImage* dest)
 	interleavedData.data_ = nullptr;
 }
 
+bool GrkImage::copyDataTo(GrkImage* dest) const
+{
+	if(!dest || !comps || !dest->comps || numcomps != dest->numcomps)
+		return false;
+
+	for(uint16_t compno = 0; compno < numcomps; compno++)
+	{
+		auto srcComp = comps + compno;
+		auto destComp = dest->comps + compno;
+		if(!srcComp->data || srcComp->w != destComp->w || srcComp->h != destComp->h)
+			return false;
+		single_component_data_free(destComp);
+		if(!allocData(destComp))
+			return false;
+		auto src = srcComp->data;
+		auto dst = destComp->data;
+		for(uint32_t j = 0; j < srcComp->h; ++j)
+		{
+			memcpy(dst, src, srcComp->w * sizeof(int32_t));
+			src += srcComp->stride;
+			dst += destComp->stride;
+		}
+	}
+
+	return true;
+}
+
 /**
  * Create new image and transfer tile buffer data
  *
@@ -990,6 +1032,7 @@ bool GrkImage::compositeInterleaved(const Tile* src, uint32_t yBegin, uint32_t y
 	switch(decompressFormat)
 	{
 		case GRK_FMT_TIF:
+		case GRK_FMT_PNG:
 			prec = destComp->prec;
 			break;
 		case GRK_FMT_PXM:
@@ -1053,6 +1096,7 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 	switch(decompressFormat)
 	{
 		case GRK_FMT_TIF:
+		case GRK_FMT_PNG:
 			prec = destComp->prec;
 			break;
 		case GRK_FMT_PXM:
@@ -72,6 +72,11 @@ class GrkImage : public grk_image
 	 */
 	void transferDataTo(GrkImage* dest);
 	void transferDataFrom(const Tile* tile_src_data);
+	/**
+	 Copy data to dest for each component, allocating dest data.
+	 Assumption:  "this" and dest have the same number of components, with same dimensions
+	 */
+	bool copyDataTo(GrkImage* dest) const;
 	GrkImage* duplicate(const Tile* tile_src);
 	bool composite(const GrkImage* src);
 	bool compositeInterleaved(const GrkImage* src);
@@ -113,11 +118,8 @@ class GrkImage : public grk_image
 	bool generateCompositeBounds(grk_rect32 src, uint16_t destCompno, grk_rect32* destWin);
 	bool allComponentsSanityCheck(bool equalPrecision);
 	grk_image* createRGB(uint16_t numcmpts, uint32_t w, uint32_t h, uint8_t prec);
-	void sycc_to_rgb(int32_t offset, int32_t upb, int32_t y, int32_t cb, int32_t cr, int32_t* out_r,
-					 int32_t* out_g, int32_t* out_b);
 	bool sycc444_to_rgb(void);
-	bool sycc422_to_rgb(bool oddFirstX);
-	bool sycc420_to_rgb(bool oddFirstX, bool oddFirstY);
+	bool sycc42x_to_rgb(bool oddFirstX, bool oddFirstY, bool verticalSubsampling);
 	bool color_sycc_to_rgb(bool oddFirstX, bool oddFirstY);
 	bool color_cmyk_to_rgb(void);
 	bool color_esycc_to_rgb(void);
@@ -1,5 +1,6 @@
 #include <grk_includes.h>
 #include "lcms2.h"
+#include "colour.h"
 
 namespace grk
 {
@@ -487,189 +488,83 @@ grk_image* GrkImage::createRGB(uint16_t numcmpts, uint32_t w, uint32_t h, uint8_
  B   |0.999823  1.77204       -8.04142e-06 |    Cr - 2^(prec - 1)
 
  -----------------------------------------------------------*/
-void GrkImage::sycc_to_rgb(int32_t offset, int32_t upb, int32_t y, int32_t cb, int32_t cr,
-						   int32_t* out_r, int32_t* out_g, int32_t* out_b)
-{
-	int32_t r, g, b;
-
-	cb -= offset;
-	cr -= offset;
-	r = y + (int32_t)(1.402 * cr);
-	if(r < 0)
-		r = 0;
-	else if(r > upb)
-		r = upb;
-	*out_r = r;
-
-	g = y - (int32_t)(0.344 * cb + 0.714 * cr);
-	if(g < 0)
-		g = 0;
-	else if(g > upb)
-		g = upb;
-	*out_g = g;
-
-	b = y + (int32_t)(1.772 * cb);
-	if(b < 0)
-		b = 0;
-	else if(b > upb)
-		b = upb;
-	*out_b = b;
-}
-
 bool GrkImage::sycc444_to_rgb(void)
 {
-	int32_t *d0, *d1, *d2, *r, *g, *b;
-	auto dst = createRGB(3, comps[0].w, comps[0].h, comps[0].prec);
-	if(!dst)
-		return false;
-
 	int32_t offset = 1 << (comps[0].prec - 1);
 	int32_t upb = (1 << comps[0].prec) - 1;
 
 	uint32_t w = comps[0].w;
-	uint32_t src_stride_diff = comps[0].stride - w;
-	uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
 	uint32_t h = comps[0].h;
-
 	auto y = comps[0].data;
 	auto cb = comps[1].data;
 	auto cr = comps[2].data;
-
-	d0 = r = dst->comps[0].data;
-	d1 = g = dst->comps[1].data;
-	d2 = b = dst->comps[2].data;
-
-	dst->comps[0].data = nullptr;
-	dst->comps[1].data = nullptr;
-	dst->comps[2].data = nullptr;
-
-	for(uint32_t j = 0; j < h; ++j)
+	if(!y || !cb || !cr)
 	{
-		for(uint32_t i = 0; i < w; ++i)
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-		y += src_stride_diff;
-		cb += src_stride_diff;
-		cr += src_stride_diff;
-		r += dst_stride_diff;
-		g += dst_stride_diff;
-		b += dst_stride_diff;
+		GRK_WARN("sycc444_to_rgb: null channel");
+		return false;
 	}
-
-	all_components_data_free();
-	comps[0].data = d0;
-	comps[1].data = d1;
-	comps[2].data = d2;
+	size_t strideY = comps[0].stride;
+	size_t strideCb = comps[1].stride;
+	size_t strideCr = comps[2].stride;
+
+	// convert in place
+	ExecSingleton::for_each_strip(
+		h, singleTileRowsPerStrip,
+		[y, cb, cr, w, strideY, strideCb, strideCr, offset, upb](uint32_t yBegin, uint32_t yEnd) {
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				auto rowY = y + j * strideY;
+				auto rowCb = cb + j * strideCb;
+				auto rowCr = cr + j * strideCr;
+				colour::sycc_to_rgb(rowY, rowCb, rowCr, rowY, rowCb, rowCr, w, offset, upb);
+			}
+		});
 	color_space = GRK_CLRSPC_SRGB;
 
-	for(uint32_t i = 0; i < numcomps; ++i)
-		comps[i].stride = dst->comps[i].stride;
-	grk_object_unref(&dst->obj);
-
 	return true;
 } /* sycc444_to_rgb() */
 
-bool GrkImage::sycc422_to_rgb(bool oddFirstX)
+/**
+ * Up-sample one row of horizontally sub-sampled chroma to full width
+ *
+ * @param src sub-sampled chroma row, or nullptr for a row with Cb/Cr = 0
+ * @param dest full width chroma row
+ * @param w full width
+ * @param oddFirstX if true, then first column shall use Cb/Cr = 0
+ */
+static void upsampleChromaRow(const int32_t* src, int32_t* dest, uint32_t w, bool oddFirstX)
 {
-	/* if img->x0 is odd, then first column shall use Cb/Cr = 0 */
-	uint32_t w = comps[0].w;
-	uint32_t h = comps[0].h;
-	uint32_t loopWidth = w;
-	if(oddFirstX)
-		loopWidth--;
-	// sanity check
-	if((loopWidth + 1) / 2 != comps[1].w)
-	{
-		GRK_WARN("incorrect subsampled width %u", comps[1].w);
-		return false;
-	}
-
-	auto dst = createRGB(3, w, h, comps[0].prec);
-	if(!dst)
-		return false;
-
-	int32_t offset = 1 << (comps[0].prec - 1);
-	int32_t upb = (1 << comps[0].prec) - 1;
-
-	uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
-	uint32_t src_stride_diff = comps[0].stride - w;
-	uint32_t src_stride_diff_chroma = comps[1].stride - comps[1].w;
-
-	int32_t *d0, *d1, *d2, *r, *g, *b;
-
-	auto y = comps[0].data;
-	if(!y)
+	uint32_t i = 0;
+	if(oddFirstX || !src)
 	{
-		GRK_WARN("sycc422_to_rgb: null luma channel");
-		return false;
-	}
-	auto cb = comps[1].data;
-	auto cr = comps[2].data;
-	if(!cb || !cr)
-	{
-		GRK_WARN("sycc422_to_rgb: null chroma channel");
-		return false;
-	}
-
-	d0 = r = dst->comps[0].data;
-	d1 = g = dst->comps[1].data;
-	d2 = b = dst->comps[2].data;
-
-	dst->comps[0].data = nullptr;
-	dst->comps[1].data = nullptr;
-	dst->comps[2].data = nullptr;
-
-	for(uint32_t i = 0U; i < h; ++i)
-	{
-		if(oddFirstX)
-			sycc_to_rgb(offset, upb, *y++, 0, 0, r++, g++, b++);
-
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
+		dest[i++] = 0;
+		if(!src)
 		{
-			sycc_to_rgb(offset, upb, *y++, *cb, *cr, r++, g++, b++);
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
+			std::fill(dest + i, dest + w, 0);
+			return;
 		}
-		if(j < loopWidth)
-			sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-
-		y += src_stride_diff;
-		cb += src_stride_diff_chroma;
-		cr += src_stride_diff_chroma;
-		r += dst_stride_diff;
-		g += dst_stride_diff;
-		b += dst_stride_diff;
 	}
-	all_components_data_free();
-
-	comps[0].data = d0;
-	comps[1].data = d1;
-	comps[2].data = d2;
-
-	comps[1].w = comps[2].w = w;
-	comps[1].h = comps[2].h = h;
-	comps[1].dx = comps[2].dx = comps[0].dx;
-	comps[1].dy = comps[2].dy = comps[0].dy;
-	color_space = GRK_CLRSPC_SRGB;
-
-	for(uint32_t i = 0; i < numcomps; ++i)
-		comps[i].stride = dst->comps[i].stride;
-	grk_object_unref(&dst->obj);
-
-	return true;
-
-} /* sycc422_to_rgb() */
+	for(; i + 1 < w; i += 2)
+	{
+		dest[i] = *src;
+		dest[i + 1] = *src++;
+	}
+	if(i < w)
+		dest[i] = *src;
+}
 
-bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
+bool GrkImage::sycc42x_to_rgb(bool oddFirstX, bool oddFirstY, bool verticalSubsampling)
 {
 	uint32_t w = comps[0].w;
 	uint32_t h = comps[0].h;
 	uint32_t loopWidth = w;
 	// if img->x0 is odd, then first column shall use Cb/Cr = 0
-	// this is handled in the loop below
 	if(oddFirstX)
 		loopWidth--;
-	uint32_t loopHeight = h;
 	// if img->y0 is odd, then first line shall use Cb/Cr = 0
+	if(!verticalSubsampling)
+		oddFirstY = false;
+	uint32_t loopHeight = h;
 	if(oddFirstY)
 		loopHeight--;
 
@@ -679,11 +574,24 @@ bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
 		GRK_WARN("incorrect subsampled width %u", comps[1].w);
 		return false;
 	}
-	if((loopHeight + 1) / 2 != comps[1].h)
+	if(verticalSubsampling && (loopHeight + 1) / 2 != comps[1].h)
 	{
 		GRK_WARN("incorrect subsampled height %u", comps[1].h);
 		return false;
 	}
+	auto y = comps[0].data;
+	auto cb = comps[1].data;
+	auto cr = comps[2].data;
+	if(!y)
+	{
+		GRK_WARN("sycc42x_to_rgb: null luma channel");
+		return false;
+	}
+	if(!cb || !cr)
+	{
+		GRK_WARN("sycc42x_to_rgb: null chroma channel");
+		return false;
+	}
 
 	auto dst = createRGB(3, w, h, comps[0].prec);
 	if(!dst)
@@ -692,101 +600,50 @@ bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
 	int32_t offset = 1 << (comps[0].prec - 1);
 	int32_t upb = (1 << comps[0].prec) - 1;
 
-	int32_t* src[3];
-	int32_t* dest[3];
-	int32_t* dest_ptr[3];
-	uint32_t stride_src[3];
-	uint32_t stride_src_diff[3];
-
-	uint32_t stride_dest = dst->comps[0].stride;
-	uint32_t stride_dest_diff = dst->comps[0].stride - w;
-
-	for(uint32_t i = 0; i < 3; ++i)
-	{
-		auto srcComp = comps + i;
-		src[i] = srcComp->data;
-		stride_src[i] = srcComp->stride;
-		stride_src_diff[i] = srcComp->stride - srcComp->w;
-
-		dest[i] = dest_ptr[i] = dst->comps[i].data;
-		dst->comps[i].data = nullptr;
-	}
-	// if img->y0 is odd, then first line shall use Cb/Cr = 0
-	if(oddFirstY)
-	{
-		for(size_t j = 0U; j < w; ++j)
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-		src[0] += stride_src_diff[0];
-		for(uint32_t i = 0; i < 3; ++i)
-			dest_ptr[i] += stride_dest_diff;
-	}
-
-	size_t i;
-	for(i = 0U; i < (loopHeight & ~(size_t)1U); i += 2U)
-	{
-		auto nextY = src[0] + stride_src[0];
-		auto nextRed = dest_ptr[0] + stride_dest;
-		auto nextGreen = dest_ptr[1] + stride_dest;
-		auto nextBlue = dest_ptr[2] + stride_dest;
-		// if img->x0 is odd, then first column shall use Cb/Cr = 0
-		if(oddFirstX)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++,
-						nextBlue++);
-
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		if(j < loopWidth)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-						nextBlue++);
-		}
-		for(uint32_t k = 0; k < 3; ++k)
-		{
-			dest_ptr[k] += stride_dest_diff + stride_dest;
-			src[k] += stride_src_diff[k];
-		}
-		src[0] += stride_src[0];
-	}
-	// final odd row has no sub-sampling
-	if(i < loopHeight)
-	{
-		// if img->x0 is odd, then first column shall use Cb/Cr = 0
-		if(oddFirstX)
-			sycc_to_rgb(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-		uint32_t j;
-		for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-		{
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-			sycc_to_rgb(offset, upb, *src[0]++, *src[1]++, *src[2]++, dest_ptr[0]++, dest_ptr[1]++,
-						dest_ptr[2]++);
-		}
-		if(j < loopWidth)
-			sycc_to_rgb(offset, upb, *src[0], *src[1], *src[2], dest_ptr[0], dest_ptr[1],
-						dest_ptr[2]);
-	}
+	size_t strideY = comps[0].stride;
+	size_t strideCb = comps[1].stride;
+	size_t strideCr = comps[2].stride;
+	size_t strideDest = dst->comps[0].stride;
+	auto r = dst->comps[0].data;
+	auto g = dst->comps[1].data;
+	auto b = dst->comps[2].data;
+
+	ExecSingleton::for_each_strip(
+		h, singleTileRowsPerStrip,
+		[=](uint32_t yBegin, uint32_t yEnd) {
+			std::unique_ptr<int32_t[]> chroma(new int32_t[2 * (size_t)w]);
+			auto rowCb = chroma.get();
+			auto rowCr = rowCb + w;
+			int64_t prevChromaRow = -1;
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				// first line of odd image shall use Cb/Cr = 0
+				bool zeroChroma = oddFirstY && j == 0;
+				uint32_t chromaRow = j;
+				if(verticalSubsampling)
+					chromaRow = zeroChroma ? 0 : (j - (oddFirstY ? 1 : 0)) / 2;
+				if(zeroChroma || chromaRow != prevChromaRow)
+				{
+					upsampleChromaRow(zeroChroma ? nullptr : cb + chromaRow * strideCb, rowCb, w,
+									  oddFirstX);
+					upsampleChromaRow(zeroChroma ? nullptr : cr + chromaRow * strideCr, rowCr, w,
+									  oddFirstX);
+					prevChromaRow = zeroChroma ? -1 : (int64_t)chromaRow;
+				}
+				size_t destOffset = j * strideDest;
+				colour::sycc_to_rgb(y + j * strideY, rowCb, rowCr, r + destOffset, g + destOffset,
+									b + destOffset, w, offset, upb);
+			}
+		});
+	for(uint32_t k = 0; k < 3; ++k)
+		dst->comps[k].data = nullptr;
 
 	all_components_data_free();
+	comps[0].data = r;
+	comps[1].data = g;
+	comps[2].data = b;
 	for(uint32_t k = 0; k < 3; ++k)
-	{
-		comps[k].data = dest[k];
 		comps[k].stride = dst->comps[k].stride;
-	}
 	comps[1].w = comps[2].w = comps[0].w;
 	comps[1].h = comps[2].h = comps[0].h;
 	comps[1].dx = comps[2].dx = comps[0].dx;
@@ -796,7 +653,7 @@ bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
 
 	return true;
 
-} /* sycc420_to_rgb() */
+} /* sycc42x_to_rgb() */
 
 bool GrkImage::color_sycc_to_rgb(bool oddFirstX, bool oddFirstY)
 {
@@ -813,12 +670,12 @@ bool GrkImage::color_sycc_to_rgb(bool oddFirstX, bool oddFirstY)
 	if((comps[0].dx == 1) && (comps[1].dx == 2) && (comps[2].dx == 2) && (comps[0].dy == 1) &&
 	   (comps[1].dy == 2) && (comps[2].dy == 2))
 	{ /* horizontal and vertical sub-sample */
-		rc = sycc420_to_rgb(oddFirstX, oddFirstY);
+		rc = sycc42x_to_rgb(oddFirstX, oddFirstY, true);
 	}
 	else if((comps[0].dx == 1) && (comps[1].dx == 2) && (comps[2].dx == 2) && (comps[0].dy == 1) &&
 			(comps[1].dy == 1) && (comps[2].dy == 1))
 	{ /* horizontal sub-sample only */
-		rc = sycc422_to_rgb(oddFirstX);
+		rc = sycc42x_to_rgb(oddFirstX, false, false);
 	}
 	else if((comps[0].dx == 1) && (comps[1].dx == 1) && (comps[2].dx == 1) && (comps[0].dy == 1) &&
 			(comps[1].dy == 1) && (comps[2].dy == 1))
@@ -847,37 +704,23 @@ bool GrkImage::color_cmyk_to_rgb(void)
 	if((numcomps < 4) || !allComponentsSanityCheck(true))
 		return false;
 
-	float sC = 1.0F / (float)((1 << comps[0].prec) - 1);
-	float sM = 1.0F / (float)((1 << comps[1].prec) - 1);
-	float sY = 1.0F / (float)((1 << comps[2].prec) - 1);
-	float sK = 1.0F / (float)((1 << comps[3].prec) - 1);
-
-	uint32_t stride_diff = comps[0].stride - w;
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < h; ++j)
-	{
-		for(uint32_t i = 0; i < w; ++i)
-		{
-			/* CMYK values from 0 to 1 */
-			float C = (float)(comps[0].data[dest_index]) * sC;
-			float M = (float)(comps[1].data[dest_index]) * sM;
-			float Y = (float)(comps[2].data[dest_index]) * sY;
-			float K = (float)(comps[3].data[dest_index]) * sK;
-
-			/* Invert all CMYK values */
-			C = 1.0F - C;
-			M = 1.0F - M;
-			Y = 1.0F - Y;
-			K = 1.0F - K;
-
-			/* CMYK -> RGB : RGB results from 0 to 255 */
-			comps[0].data[dest_index] = (int32_t)(255.0F * C * K); /* R */
-			comps[1].data[dest_index] = (int32_t)(255.0F * M * K); /* G */
-			comps[2].data[dest_index] = (int32_t)(255.0F * Y * K); /* B */
-			dest_index++;
-		}
-		dest_index += stride_diff;
-	}
+	float scale[4];
+	for(uint32_t k = 0; k < 4; ++k)
+		scale[k] = 1.0F / (float)((1 << comps[k].prec) - 1);
+
+	auto c = comps[0].data;
+	auto m = comps[1].data;
+	auto y = comps[2].data;
+	auto k = comps[3].data;
+	size_t stride = comps[0].stride;
+	ExecSingleton::for_each_strip(
+		h, singleTileRowsPerStrip, [c, m, y, k, w, stride, &scale](uint32_t yBegin, uint32_t yEnd) {
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				size_t offset = j * stride;
+				colour::cmyk_to_rgb(c + offset, m + offset, y + offset, k + offset, w, scale);
+			}
+		});
 
 	single_component_data_free(comps + 3);
 	comps[0].prec = 8;
@@ -908,48 +751,22 @@ bool GrkImage::color_esycc_to_rgb(void)
 	bool sign1 = comps[1].sgnd;
 	bool sign2 = comps[2].sgnd;
 
-	uint32_t stride_diff = comps[0].stride - w;
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < h; ++j)
-	{
-		for(uint32_t i = 0; i < w; ++i)
-		{
-			int32_t y = comps[0].data[dest_index];
-			int32_t cb = comps[1].data[dest_index];
-			int32_t cr = comps[2].data[dest_index];
-
-			if(!sign1)
-				cb -= flip_value;
-			if(!sign2)
-				cr -= flip_value;
-
-			int32_t val = (int32_t)(y - 0.0000368 * cb + 1.40199 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[0].data[dest_index] = val;
-
-			val = (int32_t)(1.0003 * y - 0.344125 * cb - 0.7141128 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[1].data[dest_index] = val;
-
-			val = (int32_t)(0.999823 * y + 1.77204 * cb - 0.000008 * cr + 0.5);
-
-			if(val > max_value)
-				val = max_value;
-			else if(val < 0)
-				val = 0;
-			comps[2].data[dest_index] = val;
-			dest_index++;
-		}
-		dest_index += stride_diff;
-	}
+	int32_t flipCb = sign1 ? 0 : flip_value;
+	int32_t flipCr = sign2 ? 0 : flip_value;
+	auto y = comps[0].data;
+	auto cb = comps[1].data;
+	auto cr = comps[2].data;
+	size_t stride = comps[0].stride;
+	ExecSingleton::for_each_strip(
+		h, singleTileRowsPerStrip,
+		[y, cb, cr, w, stride, flipCb, flipCr, max_value](uint32_t yBegin, uint32_t yEnd) {
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				size_t offset = j * stride;
+				colour::esycc_to_rgb(y + offset, cb + offset, cr + offset, w, flipCb, flipCr,
+									 max_value);
+			}
+		});
 	color_space = GRK_CLRSPC_SRGB;
 
 	return true;
@@ -1204,6 +1021,49 @@ bool GrkImage::applyColourManagement(void)
 	return true;
 }
 
+/**
+ * Apply ICC transform to first three components, strip by strip, on the executor.
+ * Each strip is interleaved into a strip-sized buffer of type T, transformed,
+ * and written back in place.
+ */
+template<typename T>
+static void applyICCRGB(cmsHTRANSFORM transform, grk_image_comp* comps, uint32_t w,
+						uint32_t stride, uint32_t h)
+{
+	auto r = comps[0].data;
+	auto g = comps[1].data;
+	auto b = comps[2].data;
+	ExecSingleton::for_each_strip(
+		h, singleTileRowsPerStrip, [transform, r, g, b, w, stride](uint32_t yBegin, uint32_t yEnd) {
+			size_t numPixels = (size_t)w * (yEnd - yBegin);
+			std::unique_ptr<T[]> inbuf(new T[numPixels * 3U]);
+			std::unique_ptr<T[]> outbuf(new T[numPixels * 3U]);
+			size_t index = 0;
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				size_t row = (size_t)j * stride;
+				for(uint32_t i = 0; i < w; ++i)
+				{
+					inbuf[index++] = (T)r[row + i];
+					inbuf[index++] = (T)g[row + i];
+					inbuf[index++] = (T)b[row + i];
+				}
+			}
+			cmsDoTransform(transform, inbuf.get(), outbuf.get(), (cmsUInt32Number)numPixels);
+			index = 0;
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				size_t row = (size_t)j * stride;
+				for(uint32_t i = 0; i < w; ++i)
+				{
+					r[row + i] = (int32_t)outbuf[index++];
+					g[row + i] = (int32_t)outbuf[index++];
+					b[row + i] = (int32_t)outbuf[index++];
+				}
+			}
+		});
+}
+
 /*#define DEBUG_PROFILE*/
 bool GrkImage::applyICC(void)
 {
@@ -1213,8 +1073,7 @@ bool GrkImage::applyICC(void)
 	cmsHPROFILE in_prof = nullptr;
 	cmsHPROFILE out_prof = nullptr;
 	cmsUInt32Number in_type, out_type;
-	size_t nr_samples, componentSize;
-	uint32_t prec, w, stride_diff, h;
+	uint32_t prec, w, stride, h;
 	GRK_COLOR_SPACE oldspace;
 	bool rc = false;
 
@@ -1234,11 +1093,10 @@ bool GrkImage::applyICC(void)
 	intent = cmsGetHeaderRenderingIntent(in_prof);
 
 	w = comps[0].w;
-	stride_diff = comps[0].stride - w;
+	stride = comps[0].stride;
 	h = comps[0].h;
 	if(!w || !h)
 		goto cleanup;
-	componentSize = (size_t)w * h;
 
 	prec = comps[0].prec;
 	oldspace = color_space;
@@ -1300,7 +1158,10 @@ bool GrkImage::applyICC(void)
 				 out_space);
 		goto cleanup;
 	}
-	transform = cmsCreateTransform(in_prof, in_type, out_prof, out_type, intent, 0);
+	// transform is shared by all strip tasks, so the (non thread-safe)
+	// one pixel cache must be disabled
+	transform = cmsCreateTransform(in_prof, in_type, out_prof, out_type, intent,
+								   ExecSingleton::get()->num_workers() > 1 ? cmsFLAGS_NOCACHE : 0);
 	if(!transform)
 	{
 		color_space = oldspace;
@@ -1309,92 +1170,13 @@ bool GrkImage::applyICC(void)
 
 	if(numcomps > 2)
 	{ /* RGB, RGBA */
-		if(prec <= 8)
-		{
-			nr_samples = componentSize * 3U;
-			auto inbuf = new uint8_t[nr_samples];
-			auto outbuf = new uint8_t[nr_samples];
-
-			auto r = comps[0].data;
-			auto g = comps[1].data;
-			auto b = comps[2].data;
-
-			size_t src_index = 0;
-			size_t dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					inbuf[dest_index++] = (uint8_t)r[src_index];
-					inbuf[dest_index++] = (uint8_t)g[src_index];
-					inbuf[dest_index++] = (uint8_t)b[src_index];
-					src_index++;
-				}
-				src_index += stride_diff;
-			}
-
-			cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-
-			src_index = 0;
-			dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					r[dest_index] = (int32_t)outbuf[src_index++];
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-					dest_index++;
-				}
-				dest_index += stride_diff;
-			}
-			delete[] inbuf;
-			delete[] outbuf;
-		}
+		if(T_BYTES(in_type) == 1)
+			applyICCRGB<uint8_t>(transform, comps, w, stride, h);
 		else
-		{
-			nr_samples = componentSize * 3U * sizeof(uint16_t);
-			auto inbuf = new uint16_t[nr_samples];
-			auto outbuf = new uint16_t[nr_samples];
-
-			auto r = comps[0].data;
-			auto g = comps[1].data;
-			auto b = comps[2].data;
-
-			size_t src_index = 0;
-			size_t dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					inbuf[dest_index++] = (uint16_t)r[src_index];
-					inbuf[dest_index++] = (uint16_t)g[src_index];
-					inbuf[dest_index++] = (uint16_t)b[src_index];
-					src_index++;
-				}
-				src_index += stride_diff;
-			}
-			cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-			src_index = 0;
-			dest_index = 0;
-			for(uint32_t j = 0; j < h; ++j)
-			{
-				for(uint32_t i = 0; i < w; ++i)
-				{
-					r[dest_index] = (int32_t)outbuf[src_index++];
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
-					dest_index++;
-				}
-				dest_index += stride_diff;
-			}
-			delete[] inbuf;
-			delete[] outbuf;
-		}
+			applyICCRGB<uint16_t>(transform, comps, w, stride, h);
 	}
 	else
 	{ /* GRAY, GRAYA */
-		nr_samples = componentSize * 3U;
 		auto newComps = new grk_image_comp[numcomps + 2U];
 		for(uint32_t i = 0; i < numcomps + 2U; ++i)
 		{
@@ -1405,8 +1187,6 @@ bool GrkImage::applyICC(void)
 		}
 		delete[] comps;
 		comps = newComps;
-		auto inbuf = new uint8_t[nr_samples];
-		auto outbuf = new uint8_t[nr_samples];
 		if(forceRGB)
 		{
 			if(numcomps == 2)
@@ -1420,43 +1200,39 @@ bool GrkImage::applyICC(void)
 			numcomps = (uint16_t)(2 + numcomps);
 		}
 		auto r = comps[0].data;
-		size_t src_index = 0;
-		size_t dest_index = 0;
-		for(uint32_t j = 0; j < h; ++j)
-		{
-			for(uint32_t i = 0; i < w; ++i)
-				inbuf[dest_index++] = (uint8_t)r[src_index++];
-			src_index += stride_diff;
-		}
-		cmsDoTransform(transform, inbuf, outbuf, (cmsUInt32Number)componentSize);
-		int32_t *g = nullptr, *b = nullptr;
-		if(forceRGB)
-		{
-			g = comps[1].data;
-			b = comps[2].data;
-		}
-		src_index = 0;
-		dest_index = 0;
-		for(uint32_t j = 0; j < h; ++j)
-		{
-			for(uint32_t i = 0; i < w; ++i)
-			{
-				r[dest_index] = (int32_t)outbuf[src_index++];
-				if(forceRGB)
+		auto g = forceRGB ? comps[1].data : nullptr;
+		auto b = forceRGB ? comps[2].data : nullptr;
+		bool toRGB = forceRGB;
+		ExecSingleton::for_each_strip(
+			h, singleTileRowsPerStrip,
+			[transform, r, g, b, toRGB, w, stride](uint32_t yBegin, uint32_t yEnd) {
+				size_t numPixels = (size_t)w * (yEnd - yBegin);
+				std::unique_ptr<uint8_t[]> inbuf(new uint8_t[numPixels]);
+				std::unique_ptr<uint8_t[]> outbuf(new uint8_t[numPixels * 3U]);
+				size_t dest_index = 0;
+				for(uint32_t j = yBegin; j < yEnd; ++j)
 				{
-					g[dest_index] = (int32_t)outbuf[src_index++];
-					b[dest_index] = (int32_t)outbuf[src_index++];
+					auto src = r + (size_t)j * stride;
+					for(uint32_t i = 0; i < w; ++i)
+						inbuf[dest_index++] = (uint8_t)src[i];
 				}
-				else
+				cmsDoTransform(transform, inbuf.get(), outbuf.get(), (cmsUInt32Number)numPixels);
+				size_t src_index = 0;
+				for(uint32_t j = yBegin; j < yEnd; ++j)
 				{
-					src_index += 2;
+					size_t dest_row = (size_t)j * stride;
+					for(uint32_t i = 0; i < w; ++i)
+					{
+						r[dest_row + i] = (int32_t)outbuf[src_index];
+						if(toRGB)
+						{
+							g[dest_row + i] = (int32_t)outbuf[src_index + 1];
+							b[dest_row + i] = (int32_t)outbuf[src_index + 2];
+						}
+						src_index += 3;
+					}
 				}
-				dest_index++;
-			}
-			dest_index += stride_diff;
-		}
-		delete[] inbuf;
-		delete[] outbuf;
+			});
 	} /* if(image->numcomps */
 	rc = true;
 	delete[] meta->color.icc_profile_buf;
@@ -1525,7 +1301,6 @@ bool GrkImage::cieLabToRGB(void)
 	// range, offset and precision for L,a and b coordinates
 	double r_L, o_L, r_a, o_a, r_b, o_b, prec_L, prec_a, prec_b;
 	double minL, maxL, mina, maxa, minb, maxb;
-	cmsUInt16Number RGB[3];
 	prec_L = (double)comps[0].prec;
 	prec_a = (double)comps[1].prec;
 	prec_b = (double)comps[2].prec;
@@ -1588,7 +1363,9 @@ bool GrkImage::cieLabToRGB(void)
 	auto in = cmsCreateLab4Profile(illuminant == GRK_CIE_D50 ? nullptr : &WhitePoint);
 	// sRGB output profile
 	auto out = cmsCreate_sRGBProfile();
-	auto transform = cmsCreateTransform(in, TYPE_Lab_DBL, out, TYPE_RGB_16, INTENT_PERCEPTUAL, 0);
+	auto transform =
+		cmsCreateTransform(in, TYPE_Lab_DBL, out, TYPE_RGB_16, INTENT_PERCEPTUAL,
+						   ExecSingleton::get()->num_workers() > 1 ? cmsFLAGS_NOCACHE : 0);
 
 	cmsCloseProfile(in);
 	cmsCloseProfile(out);
@@ -1613,9 +1390,6 @@ bool GrkImage::cieLabToRGB(void)
 	green = dest_img->comps[1].data;
 	blue = dest_img->comps[2].data;
 
-	uint32_t src_stride_diff = comps[0].stride - comps[0].w;
-	uint32_t dest_stride_diff = dest_img->comps[0].stride - dest_img->comps[0].w;
-
 	minL = -(r_L * o_L) / (pow(2, prec_L) - 1);
 	maxL = minL + r_L;
 
@@ -1625,31 +1399,40 @@ bool GrkImage::cieLabToRGB(void)
 	minb = -(r_b * o_b) / (pow(2, prec_b) - 1);
 	maxb = minb + r_b;
 
-	size_t dest_index = 0;
-	for(uint32_t j = 0; j < comps[0].h; ++j)
-	{
-		for(uint32_t k = 0; k < comps[0].w; ++k)
-		{
-			cmsCIELab Lab;
-			Lab.L = minL + (double)(*L) * (maxL - minL) / (pow(2, prec_L) - 1);
-			++L;
-			Lab.a = mina + (double)(*a) * (maxa - mina) / (pow(2, prec_a) - 1);
-			++a;
-			Lab.b = minb + (double)(*b) * (maxb - minb) / (pow(2, prec_b) - 1);
-			++b;
-
-			cmsDoTransform(transform, &Lab, RGB, 1);
-
-			red[dest_index] = RGB[0];
-			green[dest_index] = RGB[1];
-			blue[dest_index] = RGB[2];
-			dest_index++;
-		}
-		dest_index += dest_stride_diff;
-		L += src_stride_diff;
-		a += src_stride_diff;
-		b += src_stride_diff;
-	}
+	// maximum L,a and b sample values
+	double maxValL = pow(2, prec_L) - 1;
+	double maxVala = pow(2, prec_a) - 1;
+	double maxValb = pow(2, prec_b) - 1;
+	uint32_t w = comps[0].w;
+	uint32_t srcStride = comps[0].stride;
+	uint32_t destStride = dest_img->comps[0].stride;
+	// transform one row at a time, strip by strip on the executor
+	ExecSingleton::for_each_strip(
+		comps[0].h, singleTileRowsPerStrip,
+		[=](uint32_t yBegin, uint32_t yEnd) {
+			std::unique_ptr<cmsCIELab[]> Lab(new cmsCIELab[w]);
+			std::unique_ptr<cmsUInt16Number[]> RGB(new cmsUInt16Number[(size_t)w * 3U]);
+			for(uint32_t j = yBegin; j < yEnd; ++j)
+			{
+				auto srcL = L + (size_t)j * srcStride;
+				auto srca = a + (size_t)j * srcStride;
+				auto srcb = b + (size_t)j * srcStride;
+				for(uint32_t k = 0; k < w; ++k)
+				{
+					Lab[k].L = minL + (double)srcL[k] * (maxL - minL) / maxValL;
+					Lab[k].a = mina + (double)srca[k] * (maxa - mina) / maxVala;
+					Lab[k].b = minb + (double)srcb[k] * (maxb - minb) / maxValb;
+				}
+				cmsDoTransform(transform, Lab.get(), RGB.get(), w);
+				size_t destRow = (size_t)j * destStride;
+				for(uint32_t k = 0; k < w; ++k)
+				{
+					red[destRow + k] = RGB[3 * k];
+					green[destRow + k] = RGB[3 * k + 1];
+					blue[destRow + k] = RGB[3 * k + 2];
+				}
+			}
+		});
 	cmsDeleteTransform(transform);
 
 	for(i = 0; i < numcomps; ++i)
@@ -19,373 +19,498 @@
  */
 
 #include "grk_includes.h"
-#include <algorithm>
-#include <limits>
-#include <sstream>
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "wavelet/WaveletFwd.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
 namespace grk
 {
-template<typename T>
-struct dwt_line
+namespace HWY_NAMESPACE
 {
-	T* mem;
-	uint32_t dn; /* number of elements in high pass band */
-	uint32_t sn; /* number of elements in low pass band */
-	uint32_t parity; /* 0 = start on even coord, 1 = start on odd coord */
-};
+	using namespace hwy::HWY_NAMESPACE;
 
-const uint32_t NB_ELTS_V8 = 8;
+	/* From table F.4 from the standard */
+	static const float alpha = -1.586134342f;
+	static const float beta = -0.052980118f;
+	static const float gamma = 0.882911075f;
+	static const float delta = 0.443506852f;
+	static const float grk_K = 1.230174105f;
+	static const float grk_invK = (float)(1.0 / 1.230174105);
 
-/* From table F.4 from the standard */
-static const float alpha = -1.586134342f;
-static const float beta = -0.052980118f;
-static const float gamma = 0.882911075f;
-static const float delta = 0.443506852f;
-static const float grk_K = 1.230174105f;
-static const float grk_invK = (float)(1.0 / 1.230174105);
-
-#define GRK_S(i) a[(i) << 1]
-#define GRK_D(i) a[(1 + ((i) << 1))]
-#define GRK_S_(i) ((i) < 0 ? GRK_S(0) : ((i) >= sn ? GRK_S(sn - 1) : GRK_S(i)))
-#define GRK_D_(i) ((i) < 0 ? GRK_D(0) : ((i) >= dn ? GRK_D(dn - 1) : GRK_D(i)))
-#define GRK_SS_(i) ((i) < 0 ? GRK_S(0) : ((i) >= dn ? GRK_S(dn - 1) : GRK_S(i)))
-#define GRK_DD_(i) ((i) < 0 ? GRK_D(0) : ((i) >= sn ? GRK_D(sn - 1) : GRK_D(i)))
-
-/* <summary>                             */
-/* Forward lazy transform (horizontal).  */
-/* </summary>                            */
-template<typename T>
-void deinterleave_h(const T* GRK_RESTRICT a, T* GRK_RESTRICT b, int32_t dn, int32_t sn,
-					int32_t parity)
-{
-	int32_t i;
-	T* GRK_RESTRICT destPtr = b;
-	const T* GRK_RESTRICT src = a + parity;
+	static size_t hwy_fwd_num_lanes(void)
+	{
+		const HWY_FULL(int32_t) di;
+		return Lanes(di);
+	}
 
-	for(i = 0; i < sn; ++i)
+	/**
+	 * Clamp index into [0, count-1] : symmetric extension at band boundaries
+	 */
+	static inline uint32_t hwy_fwd_clamp(int64_t index, uint32_t count)
 	{
-		*destPtr++ = *src;
-		src += 2;
+		return index < 0 ? 0 : (index >= (int64_t)count ? count - 1 : (uint32_t)index);
 	}
 
-	destPtr = b + sn;
-	src = a + 1 - parity;
+	/**
+	 * Forward lazy transform (horizontal) : split row into even samples, stored at
+	 * tmp[0, (width+1)/2), and odd samples, stored at tmp[(width+1)/2, width)
+	 */
+	template<typename T>
+	static void hwy_fwd_split_h(const T* GRK_RESTRICT row, T* GRK_RESTRICT tmp, uint32_t width)
+	{
+		const HWY_FULL(T) d;
+		const size_t N = Lanes(d);
+		const uint32_t numEven = (width + 1) >> 1;
+		const uint32_t numOdd = width >> 1;
+		T* GRK_RESTRICT even = tmp;
+		T* GRK_RESTRICT odd = tmp + numEven;
+		uint32_t i = 0;
+		for(; i + N <= numOdd; i += (uint32_t)N)
+		{
+			Vec<decltype(d)> ve, vo;
+			LoadInterleaved2(d, row + 2 * i, ve, vo);
+			StoreU(ve, d, even + i);
+			StoreU(vo, d, odd + i);
+		}
+		for(; i < numOdd; ++i)
+		{
+			even[i] = row[2 * i];
+			odd[i] = row[2 * i + 1];
+		}
+		if(numEven > numOdd)
+			even[numOdd] = row[2 * numOdd];
+	}
 
-	for(i = 0; i < dn; ++i)
+	/**
+	 * 5/3 predict step: dst[i] -= (src[i + offset] + src[i + offset + 1]) >> 1
+	 */
+	static void hwy_fwd_predict_53(int32_t* GRK_RESTRICT dst, uint32_t dstCount,
+								   const int32_t* GRK_RESTRICT src, uint32_t srcCount,
+								   int32_t offset)
 	{
-		*destPtr++ = *src;
-		src += 2;
+		const HWY_FULL(int32_t) di;
+		const int64_t N = (int64_t)Lanes(di);
+		// vector range : indices whose neighbours are both inside src
+		int64_t vBegin = std::max<int64_t>(-offset, 0);
+		int64_t vEnd = std::min<int64_t>((int64_t)srcCount - 1 - offset, dstCount);
+		int64_t i = 0;
+		for(; i < std::min<int64_t>(vBegin, dstCount); ++i)
+			dst[i] -= (src[hwy_fwd_clamp(i + offset, srcCount)] +
+					   src[hwy_fwd_clamp(i + offset + 1, srcCount)]) >>
+					  1;
+		for(; i + N <= vEnd; i += N)
+		{
+			auto s = LoadU(di, src + i + offset) + LoadU(di, src + i + offset + 1);
+			StoreU(LoadU(di, dst + i) - ShiftRight<1>(s), di, dst + i);
+		}
+		for(; i < dstCount; ++i)
+			dst[i] -= (src[hwy_fwd_clamp(i + offset, srcCount)] +
+					   src[hwy_fwd_clamp(i + offset + 1, srcCount)]) >>
+					  1;
 	}
-}
-void dwt97::encode_step1_combined(float* fw, uint32_t iters_c1, uint32_t iters_c2, const float c1,
-								  const float c2)
-{
-	uint32_t i = 0;
-	const uint32_t iters_common = std::min<uint32_t>(iters_c1, iters_c2);
-	assert((((size_t)fw) & 0xf) == 0);
-	assert(abs((int32_t)iters_c1 - (int32_t)iters_c2) <= 1);
-	for(; i + 3 < iters_common; i += 4)
+
+	/**
+	 * 5/3 update step: dst[i] = in[i] + ((src[i + offset] + src[i + offset + 1] + 2) >> 2)
+	 */
+	static void hwy_fwd_update_53(int32_t* GRK_RESTRICT dst, const int32_t* GRK_RESTRICT in,
+								  uint32_t dstCount, const int32_t* GRK_RESTRICT src,
+								  uint32_t srcCount, int32_t offset)
 	{
-#ifdef __SSE__
-		const __m128 vcst = _mm_set_ps(c2, c1, c2, c1);
-		*(__m128*)fw = _mm_mul_ps(*(__m128*)fw, vcst);
-		*(__m128*)(fw + 4) = _mm_mul_ps(*(__m128*)(fw + 4), vcst);
-#else
-		fw[0] *= c1;
-		fw[1] *= c2;
-		fw[2] *= c1;
-		fw[3] *= c2;
-		fw[4] *= c1;
-		fw[5] *= c2;
-		fw[6] *= c1;
-		fw[7] *= c2;
-#endif
-		fw += 8;
+		const HWY_FULL(int32_t) di;
+		const int64_t N = (int64_t)Lanes(di);
+		const auto two = Set(di, 2);
+		int64_t vBegin = std::max<int64_t>(-offset, 0);
+		int64_t vEnd = std::min<int64_t>((int64_t)srcCount - 1 - offset, dstCount);
+		int64_t i = 0;
+		for(; i < std::min<int64_t>(vBegin, dstCount); ++i)
+			dst[i] = in[i] + ((src[hwy_fwd_clamp(i + offset, srcCount)] +
+							   src[hwy_fwd_clamp(i + offset + 1, srcCount)] + 2) >>
+							  2);
+		for(; i + N <= vEnd; i += N)
+		{
+			auto s = LoadU(di, src + i + offset) + LoadU(di, src + i + offset + 1) + two;
+			StoreU(LoadU(di, in + i) + ShiftRight<2>(s), di, dst + i);
+		}
+		for(; i < dstCount; ++i)
+			dst[i] = in[i] + ((src[hwy_fwd_clamp(i + offset, srcCount)] +
+							   src[hwy_fwd_clamp(i + offset + 1, srcCount)] + 2) >>
+							  2);
 	}
-	for(; i < iters_common; i++)
+
+	/**
+	 * 9/7 lifting step: dst[i] += (src[i + offset] + src[i + offset + 1]) * c
+	 */
+	static void hwy_fwd_lift_97(float* GRK_RESTRICT dst, uint32_t dstCount,
+								const float* GRK_RESTRICT src, uint32_t srcCount, int32_t offset,
+								float c)
 	{
-		fw[0] *= c1;
-		fw[1] *= c2;
-		fw += 2;
+		const HWY_FULL(float) df;
+		const int64_t N = (int64_t)Lanes(df);
+		const auto vc = Set(df, c);
+		int64_t vBegin = std::max<int64_t>(-offset, 0);
+		int64_t vEnd = std::min<int64_t>((int64_t)srcCount - 1 - offset, dstCount);
+		int64_t i = 0;
+		for(; i < std::min<int64_t>(vBegin, dstCount); ++i)
+			dst[i] += (src[hwy_fwd_clamp(i + offset, srcCount)] +
+					   src[hwy_fwd_clamp(i + offset + 1, srcCount)]) *
+					  c;
+		for(; i + N <= vEnd; i += N)
+		{
+			auto s = LoadU(df, src + i + offset) + LoadU(df, src + i + offset + 1);
+			StoreU(LoadU(df, dst + i) + s * vc, df, dst + i);
+		}
+		for(; i < dstCount; ++i)
+			dst[i] += (src[hwy_fwd_clamp(i + offset, srcCount)] +
+					   src[hwy_fwd_clamp(i + offset + 1, srcCount)]) *
+					  c;
 	}
-	if(i < iters_c1)
-		fw[0] *= c1;
-	else if(i < iters_c2)
-		fw[1] *= c2;
-}
 
-void dwt97::encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float c)
-{
-	uint32_t i;
-	uint32_t imax = std::min<uint32_t>(end, m);
-	if(imax > 0)
+	static void hwy_fwd_scale_97(float* GRK_RESTRICT buf, uint32_t count, float c)
 	{
-		fw[-1] += (fl[0] + fw[0]) * c;
-		fw += 2;
-		i = 1;
-		for(; i + 3 < imax; i += 4)
+		const HWY_FULL(float) df;
+		const size_t N = Lanes(df);
+		const auto vc = Set(df, c);
+		uint32_t i = 0;
+		for(; i + N <= count; i += (uint32_t)N)
+			StoreU(LoadU(df, buf + i) * vc, df, buf + i);
+		for(; i < count; ++i)
+			buf[i] *= c;
+	}
+
+	/**
+	 * Horizontal pass of 5/3 forward transform on one row,
+	 * with row deinterleaved into low pass followed by high pass
+	 */
+	static void hwy_encode_h_53(int32_t* GRK_RESTRICT row, int32_t* GRK_RESTRICT tmp,
+								uint32_t width, bool even)
+	{
+		if(width == 1)
 		{
-			fw[-1] += (fw[-2] + fw[0]) * c;
-			fw[1] += (fw[0] + fw[2]) * c;
-			fw[3] += (fw[2] + fw[4]) * c;
-			fw[5] += (fw[4] + fw[6]) * c;
-			fw += 8;
+			if(!even)
+				row[0] *= 2;
+			return;
 		}
-		for(; i < imax; ++i)
+		const uint32_t numEven = (width + 1) >> 1;
+		const uint32_t numOdd = width >> 1;
+		hwy_fwd_split_h(row, tmp, width);
+		auto evenSamples = tmp;
+		auto oddSamples = tmp + numEven;
+		if(even)
 		{
-			fw[-1] += (fw[-2] + fw[0]) * c;
-			fw += 2;
+			// low pass = even samples, high pass = odd samples
+			hwy_fwd_predict_53(oddSamples, numOdd, evenSamples, numEven, 0);
+			hwy_fwd_update_53(row, evenSamples, numEven, oddSamples, numOdd, -1);
+			memcpy(row + numEven, oddSamples, numOdd * sizeof(int32_t));
+		}
+		else
+		{
+			// low pass = odd samples, high pass = even samples
+			hwy_fwd_predict_53(evenSamples, numEven, oddSamples, numOdd, -1);
+			hwy_fwd_update_53(row, oddSamples, numOdd, evenSamples, numEven, 0);
+			memcpy(row + numOdd, evenSamples, numEven * sizeof(int32_t));
 		}
 	}
-	if(m < end)
+
+	/**
+	 * Horizontal pass of 9/7 forward transform on one row,
+	 * with row deinterleaved into low pass followed by high pass
+	 */
+	static void hwy_encode_h_97(float* GRK_RESTRICT row, float* GRK_RESTRICT tmp,
+								uint32_t width, bool even)
 	{
-		assert(m + 1 == end);
-		fw[-1] += (2 * fw[-2]) * c;
+		if(width == 1)
+			return;
+		const uint32_t numEven = (width + 1) >> 1;
+		const uint32_t numOdd = width >> 1;
+		hwy_fwd_split_h(row, tmp, width);
+		auto evenSamples = tmp;
+		auto oddSamples = tmp + numEven;
+		auto low = even ? evenSamples : oddSamples;
+		auto high = even ? oddSamples : evenSamples;
+		uint32_t sn = even ? numEven : numOdd;
+		uint32_t dn = width - sn;
+		int32_t highOffset = even ? 0 : -1;
+		int32_t lowOffset = even ? -1 : 0;
+		hwy_fwd_lift_97(high, dn, low, sn, highOffset, alpha);
+		hwy_fwd_lift_97(low, sn, high, dn, lowOffset, beta);
+		hwy_fwd_lift_97(high, dn, low, sn, highOffset, gamma);
+		hwy_fwd_lift_97(low, sn, high, dn, lowOffset, delta);
+		hwy_fwd_scale_97(low, sn, grk_invK);
+		hwy_fwd_scale_97(high, dn, grk_K);
+		memcpy(row, low, sn * sizeof(float));
+		memcpy(row + sn, high, dn * sizeof(float));
 	}
-}
 
-void dwt97::encode_1_real(float* w, int32_t dn, int32_t sn, int32_t parity)
-{
-	int32_t a, b;
-	assert(dn + sn > 1);
-	if(parity == 0)
+	/**
+	 * Vertical pass of 5/3 forward transform on pll interleaved columns,
+	 * before deinterleaving
+	 */
+	static void hwy_encode_v_53(int32_t* GRK_RESTRICT tmp, uint32_t height, bool even, size_t pll)
 	{
-		a = 0;
-		b = 1;
+		const HWY_FULL(int32_t) di;
+		const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
+		const uint32_t dn = height - sn;
+		const auto two = Set(di, 2);
+		for(size_t c = 0; c < pll; c += Lanes(di))
+		{
+			auto S = [tmp, pll, c](uint32_t i) { return tmp + ((size_t)i << 1) * pll + c; };
+			auto D = [tmp, pll, c](uint32_t i) { return tmp + (1 + ((size_t)i << 1)) * pll + c; };
+			if(height == 1)
+			{
+				if(!even)
+					Store(ShiftLeft<1>(Load(di, S(0))), di, S(0));
+				continue;
+			}
+			uint32_t i;
+			if(even)
+			{
+				for(i = 0; i + 1 < sn; i++)
+					Store(Load(di, D(i)) - ShiftRight<1>(Load(di, S(i)) + Load(di, S(i + 1))), di,
+						  D(i));
+				if((height & 1) == 0)
+					Store(Load(di, D(i)) - Load(di, S(i)), di, D(i));
+				auto dPrev = Load(di, D(0));
+				Store(Load(di, S(0)) + ShiftRight<2>(dPrev + dPrev + two), di, S(0));
+				for(i = 1; i < dn; i++)
+				{
+					auto dCur = Load(di, D(i));
+					Store(Load(di, S(i)) + ShiftRight<2>(dPrev + dCur + two), di, S(i));
+					dPrev = dCur;
+				}
+				if((height & 1) == 1)
+					Store(Load(di, S(i)) + ShiftRight<2>(dPrev + dPrev + two), di, S(i));
+			}
+			else
+			{
+				auto dPrev = Load(di, D(0));
+				Store(Load(di, S(0)) - dPrev, di, S(0));
+				for(i = 1; i < sn; i++)
+				{
+					auto dCur = Load(di, D(i));
+					Store(Load(di, S(i)) - ShiftRight<1>(dCur + dPrev), di, S(i));
+					dPrev = dCur;
+				}
+				if((height & 1) == 1)
+					Store(Load(di, S(i)) - dPrev, di, S(i));
+				for(i = 0; i + 1 < dn; i++)
+					Store(Load(di, D(i)) +
+							  ShiftRight<2>(Load(di, S(i)) + Load(di, S(i + 1)) + two),
+						  di, D(i));
+				if((height & 1) == 0)
+				{
+					auto s = Load(di, S(i));
+					Store(Load(di, D(i)) + ShiftRight<2>(s + s + two), di, D(i));
+				}
+			}
+		}
 	}
-	else
+
+	/**
+	 * 9/7 vertical lifting step on pll interleaved columns
+	 */
+	static void hwy_encode_v_step2_97(float* fl, float* fw, uint32_t end, uint32_t m, float c,
+									  size_t pll)
 	{
-		a = 1;
-		b = 0;
+		const HWY_FULL(float) df;
+		const size_t N = Lanes(df);
+		const auto vc = Set(df, c);
+		uint32_t imax = std::min<uint32_t>(end, m);
+		for(uint32_t i = 0; i < imax; ++i)
+		{
+			auto prev = i == 0 ? fl : fw - 2 * pll;
+			for(size_t k = 0; k < pll; k += N)
+			{
+				auto s = Load(df, prev + k) + Load(df, fw + k);
+				Store(Load(df, fw - pll + k) + s * vc, df, fw - pll + k);
+			}
+			fw += 2 * pll;
+		}
+		if(m < end)
+		{
+			assert(m + 1 == end);
+			const auto vc2 = Set(df, c + c);
+			for(size_t k = 0; k < pll; k += N)
+				Store(Load(df, fw - pll + k) + Load(df, fw - 2 * pll + k) * vc2, df, fw - pll + k);
+		}
 	}
-	encode_step2(w + a, w + b + 1, (uint32_t)dn, (uint32_t)std::min<int32_t>(dn, sn - b), alpha);
-	encode_step2(w + b, w + a + 1, (uint32_t)sn, (uint32_t)std::min<int32_t>(sn, dn - a), beta);
-	encode_step2(w + a, w + b + 1, (uint32_t)dn, (uint32_t)std::min<int32_t>(dn, sn - b), gamma);
-	encode_step2(w + b, w + a + 1, (uint32_t)sn, (uint32_t)std::min<int32_t>(sn, dn - a), delta);
-	if(a == 0)
-		encode_step1_combined(w, (uint32_t)sn, (uint32_t)dn, grk_invK, grk_K);
-	else
-		encode_step1_combined(w, (uint32_t)dn, (uint32_t)sn, grk_K, grk_invK);
-}
-template<typename T, typename DWT>
-struct encode_h_job
+
+	static void hwy_encode_v_step1_97(float* fw, uint32_t end, float c, size_t pll)
+	{
+		const HWY_FULL(float) df;
+		const size_t N = Lanes(df);
+		const auto vc = Set(df, c);
+		for(uint32_t i = 0; i < end; ++i)
+		{
+			for(size_t k = 0; k < pll; k += N)
+				Store(Load(df, fw + k) * vc, df, fw + k);
+			fw += 2 * pll;
+		}
+	}
+
+	/**
+	 * Vertical pass of 9/7 forward transform on pll interleaved columns,
+	 * before deinterleaving
+	 */
+	static void hwy_encode_v_97(float* GRK_RESTRICT tmp, uint32_t height, bool even, size_t pll)
+	{
+		const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
+		const uint32_t dn = height - sn;
+		if(height == 1)
+			return;
+		uint32_t a = even ? 0 : 1;
+		uint32_t b = even ? 1 : 0;
+		hwy_encode_v_step2_97(tmp + a * pll, tmp + (b + 1) * pll, dn,
+							  std::min<uint32_t>(dn, sn - b), alpha, pll);
+		hwy_encode_v_step2_97(tmp + b * pll, tmp + (a + 1) * pll, sn,
+							  std::min<uint32_t>(sn, dn - a), beta, pll);
+		hwy_encode_v_step2_97(tmp + a * pll, tmp + (b + 1) * pll, dn,
+							  std::min<uint32_t>(dn, sn - b), gamma, pll);
+		hwy_encode_v_step2_97(tmp + b * pll, tmp + (a + 1) * pll, sn,
+							  std::min<uint32_t>(sn, dn - a), delta, pll);
+		hwy_encode_v_step1_97(tmp + b * pll, dn, grk_K, pll);
+		hwy_encode_v_step1_97(tmp + a * pll, sn, grk_invK, pll);
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
 {
-	dwt_line<T> h;
-	uint32_t rw; /* Width of the resolution to process */
-	uint32_t w; /* Width of tiledp */
-	T* GRK_RESTRICT tiledp;
-	uint32_t min_j;
-	uint32_t max_j;
-	DWT dwt;
-};
+HWY_EXPORT(hwy_fwd_num_lanes);
+HWY_EXPORT(hwy_encode_h_53);
+HWY_EXPORT(hwy_encode_h_97);
+HWY_EXPORT(hwy_encode_v_53);
+HWY_EXPORT(hwy_encode_v_97);
+
+const uint32_t NB_ELTS_V8 = 8;
+
+/**
+ * Number of columns processed together in vertical pass: at least NB_ELTS_V8,
+ * and at least one full vector for the dispatched target
+ */
+static uint32_t fwd_pll_cols(void)
+{
+	return std::max<uint32_t>(NB_ELTS_V8, (uint32_t)HWY_DYNAMIC_DISPATCH(hwy_fwd_num_lanes)());
+}
+
+/* Target size in bytes of the tile data covered by a single strip task. */
+/* Keeps each task's working set resident in a core's L2 cache */
+const uint32_t FWD_DWT_STRIP_BYTES = 256 * 1024;
 
 template<typename T, typename DWT>
-void encode_h_func(encode_h_job<T, DWT>* job)
+void encode_v_strip(T* GRK_RESTRICT tiledp, T* GRK_RESTRICT scratch, uint32_t rh, bool even,
+					uint32_t stride, uint32_t min_j, uint32_t max_j, uint32_t pll)
 {
+	DWT dwt;
 	uint32_t j;
-	for(j = job->min_j; j < job->max_j; j++)
-	{
-		T* GRK_RESTRICT aj = (T*)job->tiledp + j * job->w;
-		job->dwt.encode_and_deinterleave_h_one_row((T*)aj, (T*)job->h.mem, job->rw,
-												   job->h.parity == 0 ? true : false);
-	}
-	grk_aligned_free(job->h.mem);
-	delete job;
+	for(j = min_j; j + pll - 1 < max_j; j += pll)
+		dwt.encode_and_deinterleave_v(tiledp + j, scratch, rh, even, stride, pll, pll);
+	if(j < max_j)
+		dwt.encode_and_deinterleave_v(tiledp + j, scratch, rh, even, stride, max_j - j, pll);
 }
 
 template<typename T, typename DWT>
-struct encode_v_job
+void encode_h_strip(T* GRK_RESTRICT tiledp, T* GRK_RESTRICT scratch, uint32_t rw, bool even,
+					uint32_t stride, uint32_t min_j, uint32_t max_j)
 {
-	dwt_line<T> v;
-	uint32_t rh;
-	uint32_t w;
-	T* GRK_RESTRICT tiledp;
-	uint32_t min_j;
-	uint32_t max_j;
 	DWT dwt;
-};
+	for(uint32_t j = min_j; j < max_j; j++)
+		dwt.encode_and_deinterleave_h_one_row(tiledp + (uint64_t)j * stride, scratch, rw, even);
+}
 
-template<typename T, typename DWT>
-void encode_v_func(encode_v_job<T, DWT>* job)
+/**
+ * Calculate number of columns per vertical strip: a multiple of pll,
+ * small enough to stay in cache, and small enough to keep all workers busy
+ */
+template<typename T>
+uint32_t fwd_v_strip_width(uint32_t rw, uint32_t rh, uint32_t numThreads, uint32_t pll)
 {
-	uint32_t j;
-	for(j = job->min_j; j + NB_ELTS_V8 - 1 < job->max_j; j += NB_ELTS_V8)
-		job->dwt.encode_and_deinterleave_v((T*)job->tiledp + j, (T*)job->v.mem, job->rh,
-										   job->v.parity == 0, job->w, NB_ELTS_V8);
-	if(j < job->max_j)
-		job->dwt.encode_and_deinterleave_v((T*)job->tiledp + j, (T*)job->v.mem, job->rh,
-										   job->v.parity == 0, job->w, job->max_j - j);
-	grk_aligned_free(job->v.mem);
-	delete job;
+	uint32_t cacheCols = FWD_DWT_STRIP_BYTES / (std::max<uint32_t>(rh, 1) * (uint32_t)sizeof(T));
+	uint32_t balancedCols = (rw + numThreads - 1) / numThreads;
+	uint32_t cols = std::min<uint32_t>(cacheCols, balancedCols);
+	cols = (cols / pll) * pll;
+
+	return std::max<uint32_t>(cols, pll);
 }
 
-/** Fetch up to cols <= NB_ELTS_V8 for each line, and put them in tmpOut */
-/* that has a NB_ELTS_V8 interleave factor. */
+/**
+ * Calculate number of rows per horizontal strip
+ */
+template<typename T>
+uint32_t fwd_h_strip_height(uint32_t rw, uint32_t rows, uint32_t numThreads)
+{
+	uint32_t cacheRows = FWD_DWT_STRIP_BYTES / (std::max<uint32_t>(rw, 1) * (uint32_t)sizeof(T));
+	uint32_t balancedRows = (rows + numThreads - 1) / numThreads;
+
+	return std::max<uint32_t>(std::min<uint32_t>(cacheRows, balancedRows), 1);
+}
+
+/** Fetch up to cols <= pll for each line, and put them in tmp */
+/* that has a pll interleave factor. */
 template<typename T>
 void fetch_cols_vertical_pass(const T* array, T* tmp, uint32_t height, uint32_t stride_width,
-							  uint32_t cols)
+							  uint32_t cols, uint32_t pll)
 {
-	if(cols == NB_ELTS_V8)
+	if(cols == pll)
 	{
-		uint32_t k;
-		for(k = 0; k < height; ++k)
-			memcpy(tmp + NB_ELTS_V8 * k, array + k * stride_width, NB_ELTS_V8 * sizeof(T));
+		for(uint32_t k = 0; k < height; ++k)
+			memcpy(tmp + (size_t)pll * k, array + (size_t)k * stride_width, pll * sizeof(T));
 	}
 	else
 	{
-		uint32_t k;
-		for(k = 0; k < height; ++k)
+		for(uint32_t k = 0; k < height; ++k)
 		{
-			uint32_t c;
-			for(c = 0; c < cols; c++)
-				tmp[NB_ELTS_V8 * k + c] = array[c + k * stride_width];
-			for(; c < NB_ELTS_V8; c++)
-				tmp[NB_ELTS_V8 * k + c] = 0;
+			memcpy(tmp + (size_t)pll * k, array + (size_t)k * stride_width, cols * sizeof(T));
+			memset(tmp + (size_t)pll * k + cols, 0, (pll - cols) * sizeof(T));
 		}
 	}
 }
 
-/* Deinterleave result of forward transform, where cols <= NB_ELTS_V8 */
-/* and src contains NB_ELTS_V8 consecutive values for up to NB_ELTS_V8 */
+/* Deinterleave result of forward transform, where cols <= pll */
+/* and src contains pll consecutive values for up to pll */
 /* columns. */
 template<typename T>
 void deinterleave_v_cols(const T* GRK_RESTRICT src, T* GRK_RESTRICT dst, uint32_t dn, uint32_t sn,
-						 uint32_t stride_width, uint32_t parity, uint32_t cols)
+						 uint32_t stride_width, uint32_t parity, uint32_t cols, uint32_t pll)
 {
 	int64_t i = sn;
 	T* GRK_RESTRICT destPtr = dst;
-	const T* GRK_RESTRICT srcPtr = src + parity * NB_ELTS_V8;
-	uint32_t c;
+	const T* GRK_RESTRICT srcPtr = src + parity * pll;
 
 	for(uint32_t k = 0; k < 2; k++)
 	{
 		while(i--)
 		{
-			if(cols == NB_ELTS_V8)
-			{
-				memcpy(destPtr, srcPtr, NB_ELTS_V8 * sizeof(T));
-			}
-			else
-			{
-				c = 0;
-				switch(cols)
-				{
-					case 7:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 6:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 5:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 4:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 3:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					case 2:
-						destPtr[c] = srcPtr[c];
-						c++; /* fallthru */
-					default:
-						destPtr[c] = srcPtr[c];
-						break;
-				}
-			}
+			memcpy(destPtr, srcPtr, cols * sizeof(T));
 			destPtr += stride_width;
-			srcPtr += 2 * NB_ELTS_V8;
+			srcPtr += 2 * pll;
 		}
 
 		destPtr = dst + (size_t)sn * (size_t)stride_width;
-		srcPtr = src + (1 - parity) * NB_ELTS_V8;
+		srcPtr = src + (1 - parity) * pll;
 		i = dn;
 	}
 }
-void dwt97::grk_v8dwt_encode_step1(float* fw, uint32_t end, const float cst)
-{
-	uint32_t i;
-#ifdef __SSE__
-	__m128* vw = (__m128*)fw;
-	const __m128 vcst = _mm_set1_ps(cst);
-	for(i = 0; i < end; ++i)
-	{
-		vw[0] = _mm_mul_ps(vw[0], vcst);
-		vw[1] = _mm_mul_ps(vw[1], vcst);
-		vw += 2 * (NB_ELTS_V8 * sizeof(float) / sizeof(__m128));
-	}
-#else
-	uint32_t c;
-	for(i = 0; i < end; ++i)
-	{
-		for(c = 0; c < NB_ELTS_V8; c++)
-			fw[i * 2 * NB_ELTS_V8 + c] *= cst;
-	}
-#endif
-}
-
-void dwt97::grk_v8dwt_encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float cst)
-{
-	uint32_t i;
-	uint32_t imax = std::min<uint32_t>(end, m);
-#ifdef __SSE__
-	__m128* vw = (__m128*)fw;
-	__m128 vcst = _mm_set1_ps(cst);
-	if(imax > 0)
-	{
-		__m128* vl = (__m128*)fl;
-		vw[-2] = _mm_add_ps(vw[-2], _mm_mul_ps(_mm_add_ps(vl[0], vw[0]), vcst));
-		vw[-1] = _mm_add_ps(vw[-1], _mm_mul_ps(_mm_add_ps(vl[1], vw[1]), vcst));
-		vw += 2 * (NB_ELTS_V8 * sizeof(float) / sizeof(__m128));
-		i = 1;
-
-		for(; i < imax; ++i)
-		{
-			vw[-2] = _mm_add_ps(vw[-2], _mm_mul_ps(_mm_add_ps(vw[-4], vw[0]), vcst));
-			vw[-1] = _mm_add_ps(vw[-1], _mm_mul_ps(_mm_add_ps(vw[-3], vw[1]), vcst));
-			vw += 2 * (NB_ELTS_V8 * sizeof(float) / sizeof(__m128));
-		}
-	}
-	if(m < end)
-	{
-		assert(m + 1 == end);
-		vcst = _mm_add_ps(vcst, vcst);
-		vw[-2] = _mm_add_ps(vw[-2], _mm_mul_ps(vw[-4], vcst));
-		vw[-1] = _mm_add_ps(vw[-1], _mm_mul_ps(vw[-3], vcst));
-	}
-#else
-	uint32_t c;
-	const int64_t NB_ELTS = (int64_t)NB_ELTS_V8;
-	if(imax > 0)
-	{
-		for(c = 0; c < NB_ELTS; c++)
-			fw[-1 * NB_ELTS + c] += (fl[0 * NB_ELTS + c] + fw[0 * NB_ELTS + c]) * cst;
-		fw += 2 * NB_ELTS;
-		i = 1;
-		for(; i < imax; ++i)
-		{
-			for(c = 0; c < NB_ELTS; c++)
-				fw[-1 * NB_ELTS + c] += (fw[-2 * NB_ELTS + c] + fw[0 * NB_ELTS + c]) * cst;
-			fw += 2 * NB_ELTS;
-		}
-	}
-	if(m < end)
-	{
-		assert(m + 1 == end);
-		for(c = 0; c < NB_ELTS; c++)
-			fw[-1 * NB_ELTS + c] += (2 * fw[-2 * NB_ELTS + c]) * cst;
-	}
-#endif
-}
 /* <summary>                            */
-/* Forward 5-3 wavelet transform in 2-D. */
+/* Forward wavelet transform in 2-D.     */
 /* </summary>                           */
+/*
+ * Each level is split into vertical column strips and horizontal row strips,
+ * which are scheduled across all workers of the executor as a single task graph.
+ * A horizontal strip must wait for all vertical strips of its level, but the vertical
+ * strips of the next level only depend on the horizontal strips that produce
+ * low pass rows: so, horizontal filtering of the high pass rows at level N overlaps
+ * with the vertical pass at level N+1.
+ */
 template<typename T, typename DWT>
 bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 {
 	if(tilec->numresolutions == 1U)
 		return true;
 
-	// const int num_threads = grk_thread_pool_get_thread_count(tp);
 	uint32_t stride = tilec->getWindow()->getResWindowBufferHighestSimple().stride_;
 	T* GRK_RESTRICT tiledp = (T*)tilec->getWindow()->getResWindowBufferHighestSimple().buf_;
 
@@ -393,187 +518,121 @@ bool WaveletFwdImpl::encode_procedure(TileComponent* tilec)
 	auto currentRes = tilec->resolutions_ + maxNumResolutions;
 	auto lastRes = currentRes - 1;
 
+	// vertical pass processes pll columns at a time
+	uint32_t pll = fwd_pll_cols();
 	size_t dataSize = max_resolution(tilec->resolutions_, tilec->numresolutions);
 	/* overflow check */
-	if(dataSize > (SIZE_MAX / (NB_ELTS_V8 * sizeof(int32_t))))
+	if(dataSize > (SIZE_MAX / (pll * sizeof(int32_t))))
 	{
 		GRK_ERROR("Forward wavelet overflow");
 		return false;
 	}
-	dataSize *= NB_ELTS_V8 * sizeof(int32_t);
-	auto bj = (T*)grk_aligned_malloc(dataSize);
-	/* dataSize is equal to 0 when numresolutions == 1 but bj is not used */
-	/* in that case, so do not error out */
-	if(dataSize != 0 && !bj)
-		return false;
+	dataSize *= pll * sizeof(int32_t);
+
+	// one scratch buffer per worker, reused for all levels
+	uint32_t numThreads = (uint32_t)ExecSingleton::get()->num_workers();
+	std::vector<T*> scratch(numThreads, nullptr);
+	auto freeScratch = [&scratch]() {
+		for(auto& b : scratch)
+		{
+			grk_aligned_free(b);
+			b = nullptr;
+		}
+	};
+	for(auto& b : scratch)
+	{
+		b = (T*)grk_aligned_malloc(dataSize);
+		if(!b)
+		{
+			GRK_ERROR("Forward wavelet: out of memory");
+			freeScratch();
+			return false;
+		}
+	}
+
+	tf::Taskflow taskflow;
+	// completes when all low pass rows of previous level have been filtered horizontally
+	tf::Task lowRowsDone;
+	bool haveLowRowsDone = false;
+	auto worker = []() {
+		int id = ExecSingleton::get()->this_worker_id();
+		return id < 0 ? 0U : (uint32_t)id;
+	};
+
 	int32_t i = maxNumResolutions;
-	uint32_t num_threads = ExecSingleton::get()->num_workers() > 1 ? 2 : 1;
-	DWT dwt;
 	while(i--)
 	{
 		// width of the resolution level computed
 		uint32_t rw = (uint32_t)(currentRes->x1 - currentRes->x0);
 		// height of the resolution level computed
 		uint32_t rh = (uint32_t)(currentRes->y1 - currentRes->y0);
-		// width of the resolution level once lower than computed one
-		uint32_t rw1 = (uint32_t)(lastRes->x1 - lastRes->x0);
 		// height of the resolution level once lower than computed one
 		uint32_t rh1 = (uint32_t)(lastRes->y1 - lastRes->y0);
 
 		/* 0 = non inversion on horizontal filtering 1 = inversion between low-pass and high-pass
 		 * filtering */
-		uint32_t parity_row = currentRes->x0 & 1;
+		bool evenRow = (currentRes->x0 & 1) == 0;
 		/* 0 = non inversion on vertical filtering 1 = inversion between low-pass and high-pass
 		 * filtering   */
-		uint32_t parity_col = currentRes->y0 & 1;
+		bool evenCol = (currentRes->y0 & 1) == 0;
 
-		uint32_t sn = rh1;
-		uint32_t dn = (uint32_t)(rh - rh1);
-
-		bool rc = true;
-
-		/* Perform vertical pass */
-		if(num_threads <= 1 || rw < 2 * NB_ELTS_V8)
+		if(numThreads == 1)
 		{
-			uint32_t j;
-			for(j = 0; j + NB_ELTS_V8 - 1 < rw; j += NB_ELTS_V8)
-				dwt.encode_and_deinterleave_v((T*)tiledp + j, bj, rh, parity_col == 0, stride,
-											  NB_ELTS_V8);
-			if(j < rw)
-				dwt.encode_and_deinterleave_v((T*)tiledp + j, bj, rh, parity_col == 0, stride,
-											  rw - j);
+			encode_v_strip<T, DWT>(tiledp, scratch[0], rh, evenCol, stride, 0, rw, pll);
+			encode_h_strip<T, DWT>(tiledp, scratch[0], rw, evenRow, stride, 0, rh);
 		}
 		else
 		{
-			uint32_t num_jobs = (uint32_t)num_threads;
-			uint32_t step_j;
-
-			if(rw < num_jobs)
-				num_jobs = rw;
-			step_j = ((rw / num_jobs) / NB_ELTS_V8) * NB_ELTS_V8;
-			tf::Taskflow taskflow;
-			tf::Task* node = nullptr;
-			if(num_jobs > 1)
+			/* vertical pass */
+			auto verticalDone = taskflow.placeholder();
+			uint32_t stripWidth = fwd_v_strip_width<T>(rw, rh, numThreads, pll);
+			for(uint32_t minJ = 0; minJ < rw; minJ += stripWidth)
 			{
-				node = new tf::Task[num_jobs];
-				for(uint64_t i = 0; i < num_jobs; i++)
-					node[i] = taskflow.placeholder();
+				uint32_t maxJ = std::min<uint32_t>(minJ + stripWidth, rw);
+				auto task = taskflow.emplace([&scratch, worker, tiledp, rh, evenCol, stride,
+											  minJ, maxJ, pll] {
+					encode_v_strip<T, DWT>(tiledp, scratch[worker()], rh, evenCol, stride, minJ,
+										   maxJ, pll);
+				});
+				if(haveLowRowsDone)
+					lowRowsDone.precede(task);
+				task.precede(verticalDone);
 			}
-			for(uint32_t j = 0; j < num_jobs; j++)
+			if(rw == 0 && haveLowRowsDone)
+				lowRowsDone.precede(verticalDone);
+
+			/* horizontal pass : low pass rows [0,rh1) then high pass rows [rh1,rh) */
+			lowRowsDone = taskflow.placeholder();
+			haveLowRowsDone = true;
+			verticalDone.precede(lowRowsDone);
+			for(uint32_t band = 0; band < 2; ++band)
 			{
-				auto job = new encode_v_job<T, DWT>();
-				job->v.mem = (T*)grk_aligned_malloc(dataSize);
-				if(!job->v.mem)
-				{
-					delete job;
-					grk_aligned_free(bj);
-					rc = false;
-					break;
-				}
-				job->v.dn = dn;
-				job->v.sn = sn;
-				job->v.parity = parity_col;
-				job->rh = rh;
-				job->w = stride;
-				job->tiledp = tiledp;
-				job->min_j = j * step_j;
-				job->max_j = (j + 1 == num_jobs) ? rw : (j + 1) * step_j;
-				if(node)
+				uint32_t rowBegin = band == 0 ? 0 : rh1;
+				uint32_t rowEnd = band == 0 ? rh1 : rh;
+				if(rowEnd <= rowBegin)
+					continue;
+				uint32_t stripHeight = fwd_h_strip_height<T>(rw, rowEnd - rowBegin, numThreads);
+				for(uint32_t minJ = rowBegin; minJ < rowEnd; minJ += stripHeight)
 				{
-					node[j].work([job] {
-						encode_v_func<T>(job);
-						return 0;
+					uint32_t maxJ = std::min<uint32_t>(minJ + stripHeight, rowEnd);
+					auto task = taskflow.emplace([&scratch, worker, tiledp, rw, evenRow, stride,
+												  minJ, maxJ] {
+						encode_h_strip<T, DWT>(tiledp, scratch[worker()], rw, evenRow, stride,
+											   minJ, maxJ);
 					});
+					verticalDone.precede(task);
+					if(band == 0)
+						task.precede(lowRowsDone);
 				}
-				else
-				{
-					encode_v_func<T>(job);
-				}
-			}
-			if(node)
-			{
-				ExecSingleton::get()->run(taskflow).wait();
-				delete[] node;
 			}
-			if(!rc)
-				return false;
-		}
-
-		sn = rw1;
-		dn = (uint32_t)(rw - rw1);
-
-		/* Perform horizontal pass */
-		if(num_threads <= 1 || rh <= 1)
-		{
-			uint32_t j;
-			DWT dwt;
-			for(j = 0; j < rh; j++)
-			{
-				T* GRK_RESTRICT aj = (T*)(tiledp) + j * stride;
-				dwt.encode_and_deinterleave_h_one_row(aj, bj, rw, parity_row == 0 ? true : false);
-			}
-		}
-		else
-		{
-			uint32_t num_jobs = (uint32_t)num_threads;
-			uint32_t step_j;
-
-			if(rh < num_jobs)
-				num_jobs = rh;
-			step_j = (rh / num_jobs);
-			tf::Taskflow taskflow;
-			tf::Task* node = nullptr;
-			if(num_jobs > 1)
-			{
-				node = new tf::Task[num_jobs];
-				for(uint64_t i = 0; i < num_jobs; i++)
-					node[i] = taskflow.placeholder();
-			}
-			for(uint32_t j = 0; j < num_jobs; j++)
-			{
-				auto job = new encode_h_job<T, DWT>();
-				job->h.mem = (T*)grk_aligned_malloc(dataSize);
-				if(!job->h.mem)
-				{
-					delete job;
-					grk_aligned_free(bj);
-					rc = false;
-					break;
-				}
-				job->h.dn = dn;
-				job->h.sn = sn;
-				job->h.parity = parity_row;
-				job->rw = rw;
-				job->w = stride;
-				job->tiledp = tiledp;
-				job->min_j = j * step_j;
-				job->max_j = (j + 1U) * step_j; // this can overflow
-				if(j == (num_jobs - 1U))
-				{ // this will take care of the overflow
-					job->max_j = rh;
-				}
-				if(node)
-				{
-					node[j].work([job] { encode_h_func<T, DWT>(job); });
-				}
-				else
-				{
-					encode_h_func<T, DWT>(job);
-				}
-			}
-			if(node)
-			{
-				ExecSingleton::get()->run(taskflow).wait();
-				delete[] node;
-			}
-			if(!rc)
-				return false;
 		}
 		currentRes = lastRes;
 		--lastRes;
 	}
+	if(numThreads > 1)
+		ExecSingleton::run(taskflow);
+	freeScratch();
 
-	grk_aligned_free(bj);
 	return true;
 }
 
@@ -586,333 +645,46 @@ bool WaveletFwdImpl::compress(TileComponent* tile_comp, uint8_t qmfbid)
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 /* Forward 5-3 transform, for the vertical pass, processing cols columns */
-/* where cols <= NB_ELTS_V8 */
+/* where cols <= pll */
 void dwt53::encode_and_deinterleave_v(int32_t* arrayIn, int32_t* tmpIn, uint32_t height, bool even,
-									  uint32_t stride_width, uint32_t cols)
+									  uint32_t stride_width, uint32_t cols, uint32_t pll)
 {
-	int32_t* GRK_RESTRICT array = (int32_t * GRK_RESTRICT) arrayIn;
-	int32_t* GRK_RESTRICT tmp = (int32_t * GRK_RESTRICT) tmpIn;
 	const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
 	const uint32_t dn = height - sn;
 
-	fetch_cols_vertical_pass<int32_t>(arrayIn, tmpIn, height, stride_width, cols);
-
-#define GRK_Sc(i) tmp[((i) << 1) * NB_ELTS_V8 + c]
-#define GRK_Dc(i) tmp[((1 + ((i) << 1))) * NB_ELTS_V8 + c]
-
-#ifdef __SSE2__
-	if(height == 1)
-	{
-		if(!even)
-		{
-			uint32_t c;
-			for(c = 0; c < NB_ELTS_V8; c++)
-				tmp[c] *= 2;
-		}
-	}
-	else if(even)
-	{
-		uint32_t c;
-		uint32_t i;
-		i = 0;
-		if(i + 1 < sn)
-		{
-			__m128i xmm_Si_0 = *(const __m128i*)(tmp + 4 * 0);
-			__m128i xmm_Si_1 = *(const __m128i*)(tmp + 4 * 1);
-			for(; i + 1 < sn; i++)
-			{
-				__m128i xmm_Sip1_0 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Sip1_1 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				xmm_Di_0 =
-					_mm_sub_epi32(xmm_Di_0, _mm_srai_epi32(_mm_add_epi32(xmm_Si_0, xmm_Sip1_0), 1));
-				xmm_Di_1 =
-					_mm_sub_epi32(xmm_Di_1, _mm_srai_epi32(_mm_add_epi32(xmm_Si_1, xmm_Sip1_1), 1));
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0) = xmm_Di_0;
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1) = xmm_Di_1;
-				xmm_Si_0 = xmm_Sip1_0;
-				xmm_Si_1 = xmm_Sip1_1;
-			}
-		}
-		if(((height)&1) == 0)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Dc(i) -= GRK_Sc(i);
-		}
-		for(c = 0; c < NB_ELTS_V8; c++)
-			GRK_Sc(0) += (GRK_Dc(0) + GRK_Dc(0) + 2) >> 2;
-		i = 1;
-		if(i < dn)
-		{
-			__m128i xmm_Dim1_0 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 0);
-			__m128i xmm_Dim1_1 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 1);
-			const __m128i xmm_two = _mm_set1_epi32(2);
-			for(; i < dn; i++)
-			{
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Si_0 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Si_1 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 1);
-				xmm_Si_0 = _mm_add_epi32(
-					xmm_Si_0,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Dim1_0, xmm_Di_0), xmm_two), 2));
-				xmm_Si_1 = _mm_add_epi32(
-					xmm_Si_1,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Dim1_1, xmm_Di_1), xmm_two), 2));
-				*(__m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 0) = xmm_Si_0;
-				*(__m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 1) = xmm_Si_1;
-				xmm_Dim1_0 = xmm_Di_0;
-				xmm_Dim1_1 = xmm_Di_1;
-			}
-		}
-		if(((height)&1) == 1)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(i) += (GRK_Dc(i - 1) + GRK_Dc(i - 1) + 2) >> 2;
-		}
-	}
-	else
-	{
-		uint32_t c;
-		uint32_t i;
-		for(c = 0; c < NB_ELTS_V8; c++)
-		{
-			GRK_Sc(0) -= GRK_Dc(0);
-		}
-		i = 1;
-		if(i < sn)
-		{
-			__m128i xmm_Dim1_0 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 0);
-			__m128i xmm_Dim1_1 = *(const __m128i*)(tmp + (1 + ((i - 1) << 1)) * NB_ELTS_V8 + 4 * 1);
-			for(; i < sn; i++)
-			{
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Si_0 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Si_1 = *(const __m128i*)(tmp + (i << 1) * NB_ELTS_V8 + 4 * 1);
-				xmm_Si_0 =
-					_mm_sub_epi32(xmm_Si_0, _mm_srai_epi32(_mm_add_epi32(xmm_Di_0, xmm_Dim1_0), 1));
-				xmm_Si_1 =
-					_mm_sub_epi32(xmm_Si_1, _mm_srai_epi32(_mm_add_epi32(xmm_Di_1, xmm_Dim1_1), 1));
-				*(__m128i*)(tmp + (i * 2) * NB_ELTS_V8 + 4 * 0) = xmm_Si_0;
-				*(__m128i*)(tmp + (i * 2) * NB_ELTS_V8 + 4 * 1) = xmm_Si_1;
-				xmm_Dim1_0 = xmm_Di_0;
-				xmm_Dim1_1 = xmm_Di_1;
-			}
-		}
-		if(((height)&1) == 1)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(i) -= GRK_Dc(i - 1);
-		}
-		i = 0;
-		if(i + 1 < dn)
-		{
-			__m128i xmm_Si_0 = *((const __m128i*)(tmp + 4 * 0));
-			__m128i xmm_Si_1 = *((const __m128i*)(tmp + 4 * 1));
-			const __m128i xmm_two = _mm_set1_epi32(2);
-			for(; i + 1 < dn; i++)
-			{
-				__m128i xmm_Sip1_0 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Sip1_1 = *(const __m128i*)(tmp + ((i + 1) << 1) * NB_ELTS_V8 + 4 * 1);
-				__m128i xmm_Di_0 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0);
-				__m128i xmm_Di_1 = *(const __m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1);
-				xmm_Di_0 = _mm_add_epi32(
-					xmm_Di_0,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Si_0, xmm_Sip1_0), xmm_two), 2));
-				xmm_Di_1 = _mm_add_epi32(
-					xmm_Di_1,
-					_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(xmm_Si_1, xmm_Sip1_1), xmm_two), 2));
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 0) = xmm_Di_0;
-				*(__m128i*)(tmp + (1 + (i << 1)) * NB_ELTS_V8 + 4 * 1) = xmm_Di_1;
-				xmm_Si_0 = xmm_Sip1_0;
-				xmm_Si_1 = xmm_Sip1_1;
-			}
-		}
-		if(((height)&1) == 0)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Dc(i) += (GRK_Sc(i) + GRK_Sc(i) + 2) >> 2;
-		}
-	}
-#else
-	if(even)
-	{
-		uint32_t c;
-		if(height > 1)
-		{
-			uint32_t i;
-			for(i = 0; i + 1 < sn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) -= (GRK_Sc(i) + GRK_Sc(i + 1)) >> 1;
-			}
-			if(((height) % 2) == 0)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) -= GRK_Sc(i);
-			}
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(0) += (GRK_Dc(0) + GRK_Dc(0) + 2) >> 2;
-			for(i = 1; i < dn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) += (GRK_Dc(i - 1) + GRK_Dc(i) + 2) >> 2;
-			}
-			if(((height) % 2) == 1)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) += (GRK_Dc(i - 1) + GRK_Dc(i - 1) + 2) >> 2;
-			}
-		}
-	}
-	else
-	{
-		uint32_t c;
-		if(height == 1)
-		{
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(0) *= 2;
-		}
-		else
-		{
-			uint32_t i;
-			for(c = 0; c < NB_ELTS_V8; c++)
-				GRK_Sc(0) -= GRK_Dc(0);
-			for(i = 1; i < sn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) -= (GRK_Dc(i) + GRK_Dc(i - 1)) >> 1;
-			}
-			if(((height) % 2) == 1)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Sc(i) -= GRK_Dc(i - 1);
-			}
-			for(i = 0; i + 1 < dn; i++)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) += (GRK_Sc(i) + GRK_Sc(i + 1) + 2) >> 2;
-			}
-			if(((height) % 2) == 0)
-			{
-				for(c = 0; c < NB_ELTS_V8; c++)
-					GRK_Dc(i) += (GRK_Sc(i) + GRK_Sc(i) + 2) >> 2;
-			}
-		}
-	}
-#endif
-
-	if(cols == NB_ELTS_V8)
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, NB_ELTS_V8);
-	else
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, cols);
+	fetch_cols_vertical_pass<int32_t>(arrayIn, tmpIn, height, stride_width, cols, pll);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_53)(tmpIn, height, even, pll);
+	deinterleave_v_cols(tmpIn, arrayIn, dn, sn, stride_width, even ? 0 : 1, cols, pll);
 }
 
 /** Process one line for the horizontal pass of the 5x3 forward transform */
 void dwt53::encode_and_deinterleave_h_one_row(int32_t* rowIn, int32_t* tmpIn, uint32_t width,
 											  bool even)
 {
-	int32_t* GRK_RESTRICT row = (int32_t*)rowIn;
-	int32_t* GRK_RESTRICT tmp = (int32_t*)tmpIn;
-	const int32_t sn = (int32_t)((width + (even ? 1 : 0)) >> 1);
-	const int32_t dn = (int32_t)(width - (uint32_t)sn);
-
-	if(even)
-	{
-		if(width > 1)
-		{
-			int32_t i;
-			for(i = 0; i < sn - 1; i++)
-				tmp[sn + i] = row[(i << 1) + 1] - ((row[i << 1] + row[(i + 1) << 1]) >> 1);
-			if((width & 1) == 0)
-				tmp[sn + i] = row[(i << 1) + 1] - row[i << 1];
-			row[0] += (tmp[sn] + tmp[sn] + 2) >> 2;
-			for(i = 1; i < dn; i++)
-				row[i] = row[i << 1] + ((tmp[sn + (i - 1)] + tmp[sn + i] + 2) >> 2);
-			if((width & 1) == 1)
-				row[i] = row[i << 1] + ((tmp[sn + (i - 1)] + tmp[sn + (i - 1)] + 2) >> 2);
-			memcpy(row + sn, tmp + sn, (size_t)dn * sizeof(int32_t));
-		}
-	}
-	else
-	{
-		if(width == 1)
-		{
-			row[0] = row[0] << 1;
-		}
-		else
-		{
-			int32_t i;
-			tmp[sn + 0] = row[0] - row[1];
-			for(i = 1; i < sn; i++)
-				tmp[sn + i] = row[i << 1] - ((row[(i << 1) + 1] + row[((i - 1) << 1) + 1]) >> 1);
-			if((width & 1) == 1)
-				tmp[sn + i] = row[i << 1] - row[((i - 1) << 1) + 1];
-			for(i = 0; i < dn - 1; i++)
-				row[i] = row[(i << 1) + 1] + ((tmp[sn + i] + tmp[sn + i + 1] + 2) >> 2);
-			if((width & 1) == 0)
-				row[i] = row[(i << 1) + 1] + ((tmp[sn + i] + tmp[sn + i] + 2) >> 2);
-			memcpy(row + sn, tmp + sn, (size_t)dn * sizeof(int32_t));
-		}
-	}
+	HWY_DYNAMIC_DISPATCH(hwy_encode_h_53)(rowIn, tmpIn, width, even);
 }
 
 /* Forward 9-7 transform, for the vertical pass, processing cols columns */
-/* where cols <= NB_ELTS_V8 */
+/* where cols <= pll */
 void dwt97::encode_and_deinterleave_v(float* arrayIn, float* tmpIn, uint32_t height, bool even,
-									  uint32_t stride_width, uint32_t cols)
+									  uint32_t stride_width, uint32_t cols, uint32_t pll)
 {
-	float* GRK_RESTRICT array = (float* GRK_RESTRICT)arrayIn;
-	float* GRK_RESTRICT tmp = (float* GRK_RESTRICT)tmpIn;
 	const uint32_t sn = (height + (even ? 1 : 0)) >> 1;
 	const uint32_t dn = height - sn;
-	uint32_t a, b;
 
 	if(height == 1)
 		return;
 
-	fetch_cols_vertical_pass(arrayIn, tmpIn, height, stride_width, cols);
-	if(even)
-	{
-		a = 0;
-		b = 1;
-	}
-	else
-	{
-		a = 1;
-		b = 0;
-	}
-	grk_v8dwt_encode_step2(tmp + a * NB_ELTS_V8, tmp + (b + 1) * NB_ELTS_V8, dn,
-						   std::min<uint32_t>(dn, sn - b), alpha);
-	grk_v8dwt_encode_step2(tmp + b * NB_ELTS_V8, tmp + (a + 1) * NB_ELTS_V8, sn,
-						   std::min<uint32_t>(sn, dn - a), beta);
-	grk_v8dwt_encode_step2(tmp + a * NB_ELTS_V8, tmp + (b + 1) * NB_ELTS_V8, dn,
-						   std::min<uint32_t>(dn, sn - b), gamma);
-	grk_v8dwt_encode_step2(tmp + b * NB_ELTS_V8, tmp + (a + 1) * NB_ELTS_V8, sn,
-						   std::min<uint32_t>(sn, dn - a), delta);
-	grk_v8dwt_encode_step1(tmp + b * NB_ELTS_V8, (uint32_t)dn, grk_K);
-	grk_v8dwt_encode_step1(tmp + a * NB_ELTS_V8, (uint32_t)sn, grk_invK);
-
-	if(cols == NB_ELTS_V8)
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, NB_ELTS_V8);
-	else
-		deinterleave_v_cols(tmp, array, dn, sn, stride_width, even ? 0 : 1, cols);
+	fetch_cols_vertical_pass(arrayIn, tmpIn, height, stride_width, cols, pll);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_v_97)(tmpIn, height, even, pll);
+	deinterleave_v_cols(tmpIn, arrayIn, dn, sn, stride_width, even ? 0 : 1, cols, pll);
 }
 
 /** Process one line for the horizontal pass of the 9x7 forward transform */
 void dwt97::encode_and_deinterleave_h_one_row(float* rowIn, float* tmpIn, uint32_t width, bool even)
 {
-	float* GRK_RESTRICT row = (float*)rowIn;
-	float* GRK_RESTRICT tmp = (float*)tmpIn;
-	const int32_t sn = (int32_t)((width + (even ? 1 : 0)) >> 1);
-	const int32_t dn = (int32_t)(width - (uint32_t)sn);
-	if(width == 1)
-		return;
-	memcpy(tmp, row, width * sizeof(float));
-	encode_1_real(tmp, dn, sn, even ? 0 : 1);
-	deinterleave_h(tmp, row, dn, sn, even ? 0 : 1);
+	HWY_DYNAMIC_DISPATCH(hwy_encode_h_97)(rowIn, tmpIn, width, even);
 }
 
 } // namespace grk
+#endif
@@ -26,7 +26,7 @@ class dwt53
 {
   public:
 	void encode_and_deinterleave_v(int32_t* arrayIn, int32_t* tmpIn, uint32_t height, bool even,
-								   uint32_t stride_width, uint32_t cols);
+								   uint32_t stride_width, uint32_t cols, uint32_t pll);
 
 	void encode_and_deinterleave_h_one_row(int32_t* rowIn, int32_t* tmpIn, uint32_t width,
 										   bool even);
@@ -36,18 +36,9 @@ class dwt97
 {
   public:
 	void encode_and_deinterleave_v(float* arrayIn, float* tmpIn, uint32_t height, bool even,
-								   uint32_t stride_width, uint32_t cols);
+								   uint32_t stride_width, uint32_t cols, uint32_t pll);
 
 	void encode_and_deinterleave_h_one_row(float* rowIn, float* tmpIn, uint32_t width, bool even);
-
-  private:
-	void grk_v8dwt_encode_step1(float* fw, uint32_t end, const float cst);
-	void grk_v8dwt_encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float cst);
-	void encode_step2(float* fl, float* fw, uint32_t end, uint32_t m, float c);
-
-	void encode_step1_combined(float* fw, uint32_t iters_c1, uint32_t iters_c2, const float c1,
-							   const float c2);
-	void encode_1_real(float* w, int32_t dn, int32_t sn, int32_t parity);
 };
 
 class WaveletFwdImpl